@@ -1,46 +1,102 @@
-/*
-* Copyright (c) <2020> Side Effects Software Inc.
-* All rights reserved.
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions are met:
-*
-* 1. Redistributions of source code must retain the above copyright notice,
-*    this list of conditions and the following disclaimer.
-*
-* 2. The name of Side Effects Software may not be used to endorse or
-*    promote products derived from this software without specific prior
-*    written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
-* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
-* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
-* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
-* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
-* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*/
-
-#include "HoudiniLiveLink.h"
-
-#define LOCTEXT_NAMESPACE "FHoudiniLiveLinkModule"
-
-void 
-FHoudiniLiveLinkModule::StartupModule()
-{
-	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
-}
-
-void 
-FHoudiniLiveLinkModule::ShutdownModule()
-{
-	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
-	// we call this function before unloading the module.
-}
-
-#undef LOCTEXT_NAMESPACE
-	
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "HoudiniLiveLink.h"
+#include "HoudiniLiveLinkSource.h"
+
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+#define LOCTEXT_NAMESPACE "FHoudiniLiveLinkModule"
+
+DEFINE_LOG_CATEGORY(LogHoudiniLiveLink);
+
+void 
+FHoudiniLiveLinkModule::StartupModule()
+{
+	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("HoudiniLiveLink.StartCapture"),
+		TEXT("Starts recording a take on every Houdini LiveLink source that has a capture buffer, one file per source. ")
+		TEXT("Optional argument: directory of the files (Saved/HoudiniLiveLink/Captures by default)."),
+		FConsoleCommandWithArgsDelegate::CreateRaw(this, &FHoudiniLiveLinkModule::StartCapture)));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("HoudiniLiveLink.StopCapture"),
+		TEXT("Stops the take of every Houdini LiveLink source, the files are closed once the received frames are written."),
+		FConsoleCommandWithArgsDelegate::CreateRaw(this, &FHoudiniLiveLinkModule::StopCapture)));
+}
+
+void 
+FHoudiniLiveLinkModule::ShutdownModule()
+{
+	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
+	// we call this function before unloading the module.
+	for (IConsoleObject* Command : ConsoleCommands)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(Command);
+	}
+	ConsoleCommands.Reset();
+}
+
+void
+FHoudiniLiveLinkModule::StartCapture(const TArray<FString>& Args)
+{
+	const FString Directory = Args.Num() > 0 ? Args[0] : FPaths::ProjectSavedDir() / TEXT("HoudiniLiveLink") / TEXT("Captures");
+	const FString Timestamp = FDateTime::Now().ToString();
+
+	int32 NumSources = 0;
+	FHoudiniLiveLinkSource::ForEachSource([&](FHoudiniLiveLinkSource& Source)
+	{
+		const FString Filename = Directory / FPaths::MakeValidFileName(FString::Printf(TEXT("%s_%s_%d.hllc"),
+			*Source.GetSubjectName().ToString(), *Timestamp, NumSources++));
+
+		if (Source.StartCapture(Filename))
+			UE_LOG(LogHoudiniLiveLink, Display, TEXT("Capturing %s to %s"), *Source.GetSubjectName().ToString(), *Filename);
+		else
+			UE_LOG(LogHoudiniLiveLink, Warning, TEXT("Can't capture %s: its capture buffer is 0, or its last take is still being written"), *Source.GetSubjectName().ToString());
+	});
+
+	if (NumSources == 0)
+		UE_LOG(LogHoudiniLiveLink, Warning, TEXT("No Houdini LiveLink source to capture"));
+}
+
+void
+FHoudiniLiveLinkModule::StopCapture(const TArray<FString>& Args)
+{
+	FHoudiniLiveLinkSource::ForEachSource([](FHoudiniLiveLinkSource& Source)
+	{
+		if (!Source.IsCapturing())
+			return;
+
+		Source.StopCapture();
+		UE_LOG(LogHoudiniLiveLink, Display, TEXT("Stopped capturing %s, %d frames dropped"), *Source.GetSubjectName().ToString(), Source.GetCaptureDroppedFrames());
+	});
+}
+
+#undef LOCTEXT_NAMESPACE
+	
 IMPLEMENT_MODULE(FHoudiniLiveLinkModule, HoudiniLiveLink)
\ No newline at end of file
@@ -0,0 +1,480 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "HoudiniLiveLinkEncoder.h"
+
+#include <math.h>
+#include <stdio.h>
+
+FHoudiniLiveLinkEncoder::FHoudiniLiveLinkEncoder(uint32_t InStreamId)
+	: StreamId(InStreamId)
+	, Sequence(0)
+	, SubjectId(0)
+	, SkeletonHash(HOUDINI_LIVELINK_HASH_SEED)
+	, FullCurveInterval(0)
+	, FramesSinceFullCurves(0)
+	, CurveKey(-1)
+	, Compression(HLL_COMPRESSION_NONE)
+	, CompressFunc(nullptr)
+	, CompressUserData(nullptr)
+	, CompressionThreshold(HOUDINI_LIVELINK_COMPRESSION_THRESHOLD)
+{
+}
+
+void
+FHoudiniLiveLinkEncoder::SetSubject(const char* InSubjectName)
+{
+	SubjectName = InSubjectName ? InSubjectName : "";
+	SubjectId = SubjectName.empty() ? 0 : HoudiniLiveLinkSubjectId(SubjectName.c_str(), (int32_t)SubjectName.size());
+}
+
+void
+FHoudiniLiveLinkEncoder::SetSkeleton(const char* const* InBoneNames, const int32_t* InBoneParents, int32_t InNumBones, const char* const* InCurveNames, int32_t InNumCurves)
+{
+	BoneNames.assign(InBoneNames, InBoneNames + InNumBones);
+	BoneParents.assign(InBoneParents, InBoneParents + InNumBones);
+	CurveNames.clear();
+	if (InCurveNames)
+		CurveNames.assign(InCurveNames, InCurveNames + InNumCurves);
+
+	auto GetName = [](const std::vector<std::string>& Names, int32_t Index, int32_t& OutLength)
+	{
+		OutLength = (int32_t)Names[Index].size();
+		return Names[Index].c_str();
+	};
+
+	SkeletonHash = HoudiniLiveLinkHashSkeleton(
+		(int32_t)BoneNames.size(), [&](int32_t Index, int32_t& OutLength) { return GetName(BoneNames, Index, OutLength); },
+		BoneParents.data(),
+		(int32_t)CurveNames.size(), [&](int32_t Index, int32_t& OutLength) { return GetName(CurveNames, Index, OutLength); });
+
+	// Deltas against the previous curves are meaningless now
+	ResetCurves();
+}
+
+void
+FHoudiniLiveLinkEncoder::SetSparseCurves(int32_t FullInterval)
+{
+	FullCurveInterval = FullInterval > 0 ? FullInterval : 0;
+	ResetCurves();
+}
+
+void
+FHoudiniLiveLinkEncoder::SetCompression(uint8_t InCompression, FHoudiniLiveLinkCompressFunc InCompressFunc, void* InUserData, int32_t InThreshold)
+{
+	Compression = InCompressFunc ? InCompression : (uint8_t)HLL_COMPRESSION_NONE;
+	CompressFunc = InCompressFunc;
+	CompressUserData = InUserData;
+	CompressionThreshold = InThreshold;
+}
+
+bool
+FHoudiniLiveLinkEncoder::EncodeFrame(const FHoudiniLiveLinkFrame& Frame, bool bIncludeSkeleton, uint64_t SendTime)
+{
+	Packet.clear();
+
+	Json.clear();
+	Json += '{';
+
+	if (Frame.Positions)
+		WriteVectors("positions", Frame.Positions, Frame.NumBones, 3);
+
+	if (Frame.Rotations)
+		WriteVectors("rotations", Frame.Rotations, Frame.NumBones, Frame.RotationSize == 4 ? 4 : 3);
+
+	if (Frame.Scales)
+		WriteVectors("scales", Frame.Scales, Frame.NumBones, 3);
+
+	ECurveUpdate CurveUpdate = ECurveUpdate::None;
+	if (Frame.Curves && Frame.NumCurves > 0)
+		CurveUpdate = WriteCurves(Frame.Curves, Frame.NumCurves);
+
+	if (bIncludeSkeleton)
+		WriteSkeleton();
+
+	Json += '}';
+
+	// Header, followed by the payload (compressed if it is big enough)
+	FHoudiniLiveLinkPacketHeader Header;
+	Packet.resize(sizeof(Header));
+	HoudiniLiveLinkWriteHeader(Packet.data(), (int32_t)Packet.size(), HLL_PACKET_FRAME, StreamId, Sequence, SubjectId);
+	memcpy(&Header, Packet.data(), sizeof(Header));
+	Header.SendTime = SendTime;
+	Header.SkeletonHash = (BoneNames.empty() && CurveNames.empty()) ? 0 : SkeletonHash;
+
+	const int32_t JsonSize = (int32_t)Json.size();
+	int32_t PayloadSize = 0;
+	if (CompressFunc && Compression != HLL_COMPRESSION_NONE && JsonSize >= CompressionThreshold)
+	{
+		Packet.resize(sizeof(Header) + JsonSize);
+		PayloadSize = CompressFunc(Compression, Json.data(), JsonSize, Packet.data() + sizeof(Header), JsonSize, CompressUserData);
+		if (PayloadSize > 0)
+		{
+			Header.Compression = Compression;
+			Header.UncompressedSize = (uint32_t)JsonSize;
+		}
+	}
+
+	if (PayloadSize <= 0)
+	{
+		// Not compressed, or compression didn't help
+		PayloadSize = JsonSize;
+		Packet.resize(sizeof(Header) + JsonSize);
+		memcpy(Packet.data() + sizeof(Header), Json.data(), JsonSize);
+	}
+
+	memcpy(Packet.data(), &Header, sizeof(Header));
+	Packet.resize(sizeof(Header) + PayloadSize);
+
+	if (Packet.size() > HOUDINI_LIVELINK_MAX_PACKET_SIZE)
+		return false;
+
+	// Only advance the stream once the packet can be sent: a frame that is never received
+	// mustn't use up a sequence number or become the base of the following curve deltas
+	Sequence++;
+	if (CurveUpdate == ECurveUpdate::Full)
+	{
+		BaseCurves.assign(Frame.Curves, Frame.Curves + Frame.NumCurves);
+		CurveKey = (CurveKey + 1) & 0x7FFFFFFF;
+		FramesSinceFullCurves = 0;
+	}
+	else if (CurveUpdate == ECurveUpdate::Delta)
+	{
+		FramesSinceFullCurves++;
+	}
+
+	return true;
+}
+
+FHoudiniLiveLinkEncoder::ECurveUpdate
+FHoudiniLiveLinkEncoder::WriteCurves(const float* Curves, int32_t NumCurves)
+{
+	const bool bSparse = FullCurveInterval > 0;
+	const bool bFull = !bSparse
+		|| CurveKey < 0
+		|| (int32_t)BaseCurves.size() != NumCurves
+		|| FramesSinceFullCurves >= FullCurveInterval;
+
+	if (bFull)
+	{
+		WriteFloats("blendshape_values", Curves, NumCurves);
+
+		if (!bSparse)
+			return ECurveUpdate::None;
+
+		// Becomes the base of the following deltas
+		WriteKey("blendshape_key");
+		Json += std::to_string((CurveKey + 1) & 0x7FFFFFFF);
+		return ECurveUpdate::Full;
+	}
+
+	// Only send the curves that differ from the last full frame
+	DeltaIndices.clear();
+	DeltaValues.clear();
+	for (int32_t CurveIdx = 0; CurveIdx < NumCurves; ++CurveIdx)
+	{
+		if (Curves[CurveIdx] != BaseCurves[CurveIdx])
+		{
+			DeltaIndices.push_back(CurveIdx);
+			DeltaValues.push_back(Curves[CurveIdx]);
+		}
+	}
+
+	WriteKey("blendshape_delta_indices");
+	Json += '[';
+	for (size_t i = 0; i < DeltaIndices.size(); ++i)
+	{
+		if (i > 0)
+			Json += ',';
+		Json += std::to_string(DeltaIndices[i]);
+	}
+	Json += ']';
+
+	WriteFloats("blendshape_delta_values", DeltaValues.data(), (int32_t)DeltaValues.size());
+
+	WriteKey("blendshape_key");
+	Json += std::to_string(CurveKey);
+
+	return ECurveUpdate::Delta;
+}
+
+void
+FHoudiniLiveLinkEncoder::WriteSkeleton()
+{
+	WriteKey("parents");
+	Json += '[';
+	for (size_t BoneIdx = 0; BoneIdx < BoneParents.size(); ++BoneIdx)
+	{
+		if (BoneIdx > 0)
+			Json += ',';
+
+		if (BoneParents[BoneIdx] < 0)
+			Json += "null";
+		else
+			Json += std::to_string(BoneParents[BoneIdx]);
+	}
+	Json += ']';
+
+	WriteStrings("names", BoneNames);
+
+	if (!CurveNames.empty())
+		WriteStrings("blendshape_names", CurveNames);
+
+	// The receiver needs the name of a subject before it can push its skeleton
+	if (!SubjectName.empty())
+	{
+		WriteKey("subject");
+		WriteString(SubjectName);
+	}
+}
+
+void
+FHoudiniLiveLinkEncoder::WriteKey(const char* Key)
+{
+	if (Json.size() > 1)
+		Json += ',';
+
+	Json += '"';
+	Json += Key;
+	Json += "\":";
+}
+
+int32_t
+HoudiniLiveLinkFormatFloat(float Value, char* Buffer, int32_t BufferSize)
+{
+	if (!Buffer || BufferSize <= 0)
+		return 0;
+
+	// JSON has no representation for NaN/Inf
+	if (!isfinite(Value))
+		Value = 0.0f;
+
+	// 9 significant digits round-trip a float exactly
+	char Formatted[32];
+	const int FormattedLength = snprintf(Formatted, sizeof(Formatted), "%.9g", (double)Value);
+	if (FormattedLength <= 0 || FormattedLength >= (int)sizeof(Formatted))
+		return 0;
+
+	// printf follows LC_NUMERIC, which the host application (Houdini's Qt) can set to a locale with a comma,
+	// or a multibyte decimal separator. Only the separator is localized: write whatever it is as a '.'.
+	int32_t Length = 0;
+	bool bInSeparator = false;
+	for (int i = 0; i < FormattedLength && Length < BufferSize - 1; ++i)
+	{
+		const char c = Formatted[i];
+		if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == 'e')
+		{
+			Buffer[Length++] = c;
+			bInSeparator = false;
+		}
+		else if (!bInSeparator)
+		{
+			Buffer[Length++] = '.';
+			bInSeparator = true;
+		}
+	}
+
+	Buffer[Length] = 0;
+	return Length;
+}
+
+void
+FHoudiniLiveLinkEncoder::WriteFloat(float Value)
+{
+	char Buffer[32];
+	Json.append(Buffer, HoudiniLiveLinkFormatFloat(Value, Buffer, sizeof(Buffer)));
+}
+
+void
+FHoudiniLiveLinkEncoder::WriteVectors(const char* Key, const float* Values, int32_t Count, int32_t Size)
+{
+	WriteKey(Key);
+	Json += '[';
+	for (int32_t i = 0; i < Count; ++i)
+	{
+		if (i > 0)
+			Json += ',';
+
+		Json += '[';
+		for (int32_t Component = 0; Component < Size; ++Component)
+		{
+			if (Component > 0)
+				Json += ',';
+			WriteFloat(Values[i * Size + Component]);
+		}
+		Json += ']';
+	}
+	Json += ']';
+}
+
+void
+FHoudiniLiveLinkEncoder::WriteFloats(const char* Key, const float* Values, int32_t Count)
+{
+	WriteKey(Key);
+	Json += '[';
+	for (int32_t i = 0; i < Count; ++i)
+	{
+		if (i > 0)
+			Json += ',';
+		WriteFloat(Values[i]);
+	}
+	Json += ']';
+}
+
+void
+FHoudiniLiveLinkEncoder::WriteString(const std::string& Value)
+{
+	Json += '"';
+	for (char Char : Value)
+	{
+		switch (Char)
+		{
+			case '"':	Json += "\\\""; break;
+			case '\\':	Json += "\\\\"; break;
+			case '\n':	Json += "\\n"; break;
+			case '\r':	Json += "\\r"; break;
+			case '\t':	Json += "\\t"; break;
+			default:
+				if ((unsigned char)Char < 0x20)
+				{
+					char Buffer[8];
+					snprintf(Buffer, sizeof(Buffer), "\\u%04x", (unsigned)Char);
+					Json += Buffer;
+				}
+				else
+				{
+					Json += Char;
+				}
+				break;
+		}
+	}
+	Json += '"';
+}
+
+void
+FHoudiniLiveLinkEncoder::WriteStrings(const char* Key, const std::vector<std::string>& Values)
+{
+	WriteKey(Key);
+	Json += '[';
+	for (size_t i = 0; i < Values.size(); ++i)
+	{
+		if (i > 0)
+			Json += ',';
+		WriteString(Values[i]);
+	}
+	Json += ']';
+}
+
+void*
+HoudiniLiveLinkEncoder_Create(uint32_t StreamId)
+{
+	return new FHoudiniLiveLinkEncoder(StreamId);
+}
+
+void
+HoudiniLiveLinkEncoder_Destroy(void* Encoder)
+{
+	delete (FHoudiniLiveLinkEncoder*)Encoder;
+}
+
+void
+HoudiniLiveLinkEncoder_SetSubject(void* Encoder, const char* SubjectName)
+{
+	if (Encoder)
+		((FHoudiniLiveLinkEncoder*)Encoder)->SetSubject(SubjectName);
+}
+
+void
+HoudiniLiveLinkEncoder_SetSkeleton(void* Encoder, const char* const* BoneNames, const int32_t* BoneParents, int32_t NumBones, const char* const* CurveNames, int32_t NumCurves)
+{
+	if (Encoder)
+		((FHoudiniLiveLinkEncoder*)Encoder)->SetSkeleton(BoneNames, BoneParents, NumBones, CurveNames, NumCurves);
+}
+
+void
+HoudiniLiveLinkEncoder_SetSparseCurves(void* Encoder, int32_t FullInterval)
+{
+	if (Encoder)
+		((FHoudiniLiveLinkEncoder*)Encoder)->SetSparseCurves(FullInterval);
+}
+
+void
+HoudiniLiveLinkEncoder_SetCompression(void* Encoder, uint8_t Compression, FHoudiniLiveLinkCompressFunc CompressFunc, void* UserData, int32_t Threshold)
+{
+	if (Encoder)
+		((FHoudiniLiveLinkEncoder*)Encoder)->SetCompression(Compression, CompressFunc, UserData, Threshold);
+}
+
+void
+HoudiniLiveLinkEncoder_ResetCurves(void* Encoder)
+{
+	if (Encoder)
+		((FHoudiniLiveLinkEncoder*)Encoder)->ResetCurves();
+}
+
+static int32_t
+HoudiniLiveLinkEncoder_Encode(void* Encoder, int32_t NumBones, const float* Positions, const float* Rotations, int32_t RotationSize, const float* Scales,
+	int32_t NumCurves, const float* Curves, int32_t bIncludeSkeleton, uint64_t SendTime, const uint8_t** OutData)
+{
+	if (!Encoder || !OutData)
+		return 0;
+
+	FHoudiniLiveLinkFrame Frame;
+	Frame.NumBones = NumBones;
+	Frame.Positions = Positions;
+	Frame.Rotations = Rotations;
+	Frame.RotationSize = RotationSize;
+	Frame.Scales = Scales;
+	Frame.NumCurves = NumCurves;
+	Frame.Curves = Curves;
+
+	FHoudiniLiveLinkEncoder* Self = (FHoudiniLiveLinkEncoder*)Encoder;
+	if (!Self->EncodeFrame(Frame, bIncludeSkeleton != 0, SendTime))
+		return 0;
+
+	*OutData = Self->GetPacketData();
+	return Self->GetPacketSize();
+}
+
+int32_t
+HoudiniLiveLinkEncoder_EncodeFrame(void* Encoder, int32_t NumBones, const float* Positions, const float* Rotations, const float* Scales,
+	int32_t NumCurves, const float* Curves, int32_t bIncludeSkeleton, uint64_t SendTime, const uint8_t** OutData)
+{
+	return HoudiniLiveLinkEncoder_Encode(Encoder, NumBones, Positions, Rotations, 3, Scales, NumCurves, Curves, bIncludeSkeleton, SendTime, OutData);
+}
+
+int32_t
+HoudiniLiveLinkEncoder_EncodeFrameQuat(void* Encoder, int32_t NumBones, const float* Positions, const float* Rotations, const float* Scales,
+	int32_t NumCurves, const float* Curves, int32_t bIncludeSkeleton, uint64_t SendTime, const uint8_t** OutData)
+{
+	return HoudiniLiveLinkEncoder_Encode(Encoder, NumBones, Positions, Rotations, 4, Scales, NumCurves, Curves, bIncludeSkeleton, SendTime, OutData);
+}
+
+int32_t
+HoudiniLiveLinkEncoder_MakePong(const uint8_t* Ping, int32_t PingSize, uint8_t* Pong, int32_t PongSize, uint64_t ReceiveTime, uint64_t SendTime)
+{
+	return HoudiniLiveLinkMakePong(Ping, PingSize, Pong, PongSize, ReceiveTime, SendTime);
+}
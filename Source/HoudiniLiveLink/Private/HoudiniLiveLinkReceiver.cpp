@@ -0,0 +1,1270 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "HoudiniLiveLinkReceiver.h"
+#include "HoudiniLiveLink.h"
+#include "HoudiniLiveLinkProtocol.h"
+#include "HoudiniLiveLinkSkeletonCache.h"
+
+#include "ILiveLinkClient.h"
+#include "LiveLinkTypes.h"
+#include "Roles/LiveLinkAnimationRole.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#include "Hash/CityHash.h"
+#include "Misc/Compression.h"
+#include "Stats/Stats.h"
+
+#include "Async/Async.h"
+#include "HAL/RunnableThread.h"
+
+// The latency stats are created for each source, see FHoudiniLiveLinkReceiver::FHoudiniLiveLinkReceiver
+DECLARE_STATS_GROUP(TEXT("Houdini LiveLink"), STATGROUP_HoudiniLiveLink, STATCAT_Advanced);
+
+// Converts FPlatformTime::Seconds() to the microseconds used by the protocol
+static uint64
+ToMicroseconds(double Seconds)
+{
+	return (uint64)(Seconds * 1000000.0);
+}
+
+const double
+FHoudiniLiveLinkLatencyHistogram::BucketSize = 0.1;
+
+const double
+FHoudiniLiveLinkReceiver::TransformScale = 1.0;
+
+const double
+FHoudiniLiveLinkReceiver::IdleRefreshDelay = 0.5;
+
+const double
+FHoudiniLiveLinkReceiver::SubjectTimeout = 300.0;
+
+const double
+FHoudiniLiveLinkReceiver::UnnamedSubjectTimeout = 5.0;
+
+const int32
+FHoudiniLiveLinkReceiver::MaxSubjects = 256;
+
+const double
+FHoudiniLiveLinkReceiver::PingInterval = 1.0;
+
+const double
+FHoudiniLiveLinkReceiver::LatencyWindow = 2.0;
+
+const double
+FHoudiniLiveLinkReceiver::PingTimeout = 3.0;
+
+FHoudiniLiveLinkReceiver::FHoudiniLiveLinkReceiver(FHoudiniLiveLinkSource& InSource, int32 InIndex)
+	: Source(InSource)
+	, Index(InIndex)
+	, Thread(nullptr)
+	, LastExpireTime(0.0)
+	, bFramePushed(false)
+	, LatencyWindowStart(0.0)
+{
+	// The queue keeps one slot empty
+	if (Source.Options.CaptureBufferSize > 0)
+		CaptureQueue = MakeUnique<TCircularQueue<FHoudiniLiveLinkCapturedFrame>>(Source.Options.CaptureBufferSize + 1);
+
+#if STATS
+	// The first receiver publishes the stats of the source, named after it so every source has its own
+	if (Index == 0)
+	{
+		const FString SourceName = FString::Printf(TEXT("%s (%s)"), *Source.SubjectName.ToString(), *Source.DeviceEndpoint.ToString());
+		LatencyP50StatId = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_HoudiniLiveLink>(SourceName + TEXT(" Latency p50 (ms)"), true);
+		LatencyP95StatId = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_HoudiniLiveLink>(SourceName + TEXT(" Latency p95 (ms)"), true);
+		LatencyP99StatId = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_HoudiniLiveLink>(SourceName + TEXT(" Latency p99 (ms)"), true);
+		RoundTripTimeStatId = FDynamicStats::CreateStatIdDouble<FStatGroup_STATGROUP_HoudiniLiveLink>(SourceName + TEXT(" Round Trip Time (ms)"), true);
+	}
+#endif
+}
+
+FHoudiniLiveLinkReceiver::~FHoudiniLiveLinkReceiver()
+{
+	Stop();
+	if (Thread != nullptr)
+	{
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+// FRunnable interface
+void
+FHoudiniLiveLinkReceiver::Start()
+{
+	ThreadName = "Houdini Live Link ";
+	ThreadName.AppendInt(FAsyncThreadIndex::GetNext());
+
+	Thread = FRunnableThread::Create(this, *ThreadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask());
+}
+
+void
+FHoudiniLiveLinkReceiver::Stop()
+{
+	Source.Stopping = true;
+}
+
+const int BUFFER_SIZE = 65536;
+uint32
+FHoudiniLiveLinkReceiver::Run()
+{
+	const FHoudiniLiveLinkSourceOptions& Options = Source.Options;
+
+	// Every receiver binds the same port: AsReusable() also sets SO_REUSEPORT where it exists,
+	// which makes the system spread the senders between the sockets, by address and port.
+	FUdpSocketBuilder builder("Houdini Live Link Receiver");
+	builder.AsBlocking();
+	builder.AsReusable();
+	builder.BoundToAddress(FIPv4Address::Any);
+	builder.BoundToPort(Source.DeviceEndpoint.Port);
+	builder.WithReceiveBufferSize(BUFFER_SIZE);
+
+	if (Options.UsesMulticast())
+	{
+		// Let a single send from Houdini reach every receiver that joined the group
+		builder.JoinedToGroup(Options.MulticastGroup, Options.MulticastInterface);
+		builder.WithMulticastInterface(Options.MulticastInterface);
+		builder.WithMulticastTtl(Options.MulticastTtl);
+		builder.WithMulticastLoopback();
+	}
+
+	char buf[BUFFER_SIZE];
+	
+	FSocket* socket = builder.Build();
+	if (socket)
+	{
+		if (socket->GetConnectionState() != ESocketConnectionState::SCS_Connected)
+			return 0;
+		
+		TSharedRef<FInternetAddr> SenderAddress = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+		while (!Source.Stopping)
+		{
+			UpdateLatency(socket, FPlatformTime::Seconds());
+			ExpireSubjects(FPlatformTime::Seconds());
+
+			int32 num_read;
+			if (socket->Wait(ESocketWaitConditions::WaitForRead, 100))
+			{
+				socket->RecvFrom((uint8*)buf, BUFFER_SIZE, num_read, *SenderAddress);
+				if (num_read <= 0)
+					continue;
+
+				ProcessPacket(buf, num_read, *SenderAddress, FPlatformTime::Seconds());
+			}
+		}
+		socket->Close();
+	}
+	return 0;
+}
+
+void
+FHoudiniLiveLinkReceiver::ProcessPacket(const char* Packet, int32 PacketSize, const FInternetAddr& SenderAddress, double Now)
+{
+	// Packets without a header are raw JSON from older senders, they aren't sequenced
+	// and belong to the source's subject
+	const char* Payload = Packet;
+	int32 PayloadSize = PacketSize;
+	FHoudiniLiveLinkPacketHeader Header;
+	const bool bHasHeader = HoudiniLiveLinkReadHeader(Packet, PacketSize, Header);
+	Header.Compression = bHasHeader ? Header.Compression : (uint8)HLL_COMPRESSION_NONE;
+	if (bHasHeader && Header.Type == HLL_PACKET_PONG)
+	{
+		if (FHoudiniLiveLinkSubjectState* PongSubject = Subjects.Find(Header.SubjectId))
+			ProcessPong(*PongSubject, Header, Packet + Header.HeaderSize, PacketSize - Header.HeaderSize, SenderAddress, Now);
+		return;
+	}
+
+	if (bHasHeader && Header.Type != HLL_PACKET_FRAME)
+		return;
+
+	FHoudiniLiveLinkSubjectState* SubjectPtr = GetSubject(bHasHeader ? Header.SubjectId : 0, Now);
+	if (!SubjectPtr)
+		return;
+
+	FHoudiniLiveLinkSubjectState& Subject = *SubjectPtr;
+	if (bHasHeader)
+	{
+		// Reject stale or duplicate frames so a late packet can't overwrite a newer pose
+		const bool bAccepted = Subject.SequenceTracker.Accept(Header.StreamId, Header.Sequence);
+		{
+			FScopeLock Lock(&StatsLock);
+			StreamStats.FindOrAdd(Header.SubjectId) = Subject.SequenceTracker.GetStats();
+		}
+
+		if (!bAccepted)
+			return;
+
+		if (Header.SendTime != 0)
+		{
+			// The sender timestamps its frames: ping it to measure the latency.
+			// A different sender, or a restarted one, has a different clock.
+			if (!Subject.LatencySenderAddress.IsValid() || !(*Subject.LatencySenderAddress == SenderAddress) || Header.StreamId != Subject.LatencyStreamId)
+			{
+				Subject.LatencySenderAddress = SenderAddress.Clone();
+				Subject.LatencyStreamId = Header.StreamId;
+				Subject.ClockSync.Reset();
+			}
+
+			Subject.LastTimestampedFrameTime = Now;
+
+			if (Subject.ClockSync.HasOffset())
+			{
+				const int64 LatencyUs = (int64)(ToMicroseconds(Now) - Header.SendTime) + Subject.ClockSync.GetOffset();
+				LatencyHistogram.Add(LatencyUs / 1000.0);
+			}
+		}
+
+		Payload += Header.HeaderSize;
+		PayloadSize -= Header.HeaderSize;
+	}
+
+	// Houdini sends the current pose on every UI event, even when playback is stopped.
+	// Skip parsing payloads identical to the last frame we pushed.
+	const uint64 PayloadHash = CityHash64(Payload, PayloadSize);
+	if (!Subject.SkeletonSetupNeeded && PayloadSize == Subject.LastPayloadSize && PayloadHash == Subject.LastPayloadHash)
+	{
+		// Takes still record the held frames, at the rate they're sent
+		if (Source.bCapturing)
+		{
+			FLiveLinkAnimationFrameData FrameData;
+			Subject.GetLastFrameData(FrameData);
+			CaptureFrame(Subject, MoveTemp(FrameData), Header.SendTime);
+		}
+
+		RefreshIdleSubject(Subject);
+		return;
+	}
+
+	// Large packets can be compressed by the sender
+	const char* Data = Payload;
+	int32 DataSize = PayloadSize;
+	if (Header.Compression != HLL_COMPRESSION_NONE)
+	{
+		if (!DecompressPayload(Header.Compression, Header.UncompressedSize, Payload, PayloadSize))
+		{
+			Subject.LastPayloadSize = -1;
+			return;
+		}
+
+		Data = (const char*)DecompressionBuffer.GetData();
+		DataSize = DecompressionBuffer.Num();
+	}
+
+	// Payloads are UTF-8
+	const FUTF8ToTCHAR DecodedData(Data, DataSize);
+	const bool bProcessed = ProcessResponseData(Subject, FString(DecodedData.Length(), DecodedData.Get()), Header.SkeletonHash, Header.SendTime);
+
+	if (bProcessed && bFramePushed)
+	{
+		Subject.LastPayloadHash = PayloadHash;
+		Subject.LastPayloadSize = PayloadSize;
+	}
+	else
+	{
+		Subject.LastPayloadSize = -1;
+	}
+}
+
+const FHoudiniLiveLinkSubjectState*
+FHoudiniLiveLinkReceiver::FindSubject(uint32 SubjectId) const
+{
+	return Subjects.Find(SubjectId);
+}
+
+FHoudiniLiveLinkSubjectState*
+FHoudiniLiveLinkReceiver::GetSubject(uint32 SubjectId, double Now)
+{
+	FHoudiniLiveLinkSubjectState* Subject = Subjects.Find(SubjectId);
+	if (!Subject)
+	{
+		// Garbage or a flood of subject ids mustn't grow the map forever
+		if (Subjects.Num() >= MaxSubjects)
+		{
+			ExpireSubjects(Now);
+			if (Subjects.Num() >= MaxSubjects)
+				return nullptr;
+		}
+
+		// Named subjects get their name from their static data
+		Subject = &Subjects.Add(SubjectId);
+		Subject->SubjectId = SubjectId;
+		if (SubjectId == 0)
+			Subject->SubjectName = Source.SubjectName;
+	}
+
+	Subject->LastPacketTime = Now;
+	return Subject;
+}
+
+void
+FHoudiniLiveLinkReceiver::ExpireSubjects(double Now)
+{
+	if ((Now - LastExpireTime) < UnnamedSubjectTimeout)
+		return;
+
+	LastExpireTime = Now;
+
+	TArray<uint32, TInlineAllocator<16>> ExpiredIds;
+	for (const TPair<uint32, FHoudiniLiveLinkSubjectState>& Pair : Subjects)
+	{
+		const FHoudiniLiveLinkSubjectState& Subject = Pair.Value;
+		const double Timeout = Subject.SubjectName.IsNone() ? UnnamedSubjectTimeout : SubjectTimeout;
+		if (Subject.SubjectId != 0 && (Now - Subject.LastPacketTime) >= Timeout)
+			ExpiredIds.Add(Pair.Key);
+	}
+
+	if (ExpiredIds.Num() <= 0)
+		return;
+
+	FScopeLock Lock(&StatsLock);
+	for (uint32 SubjectId : ExpiredIds)
+	{
+		Subjects.Remove(SubjectId);
+		StreamStats.Remove(SubjectId);
+	}
+}
+
+void
+FHoudiniLiveLinkReceiver::UpdateLatency(FSocket* Socket, double Now)
+{
+	for (TPair<uint32, FHoudiniLiveLinkSubjectState>& Pair : Subjects)
+	{
+		FHoudiniLiveLinkSubjectState& Subject = Pair.Value;
+		if (!Subject.LatencySenderAddress.IsValid() || (Now - Subject.LastPingTime) < PingInterval)
+			continue;
+
+		// The sender stopped streaming, or doesn't timestamp its frames anymore
+		if ((Now - Subject.LastTimestampedFrameTime) >= PingTimeout)
+			continue;
+
+		Subject.LastPingTime = Now;
+
+		uint8 Ping[sizeof(FHoudiniLiveLinkPacketHeader) + sizeof(uint64)];
+		const int32 HeaderSize = HoudiniLiveLinkWriteHeader(Ping, sizeof(Ping), HLL_PACKET_PING, Subject.LatencyStreamId, 0, Pair.Key);
+		const uint64 PingTime = ToMicroseconds(Now);
+		FMemory::Memcpy(Ping + HeaderSize, &PingTime, sizeof(PingTime));
+
+		int32 BytesSent = 0;
+		Socket->SendTo(Ping, HeaderSize + sizeof(PingTime), BytesSent, *Subject.LatencySenderAddress);
+	}
+
+	if ((Now - LatencyWindowStart) < LatencyWindow)
+		return;
+
+	LatencyWindowStart = Now;
+
+	// Report the clock of the sender that is the furthest away
+	FHoudiniLiveLinkLatencyStats ClockStats;
+	for (const TPair<uint32, FHoudiniLiveLinkSubjectState>& Pair : Subjects)
+	{
+		const FHoudiniLiveLinkClockSync& ClockSync = Pair.Value.ClockSync;
+		if (ClockSync.HasOffset() && ClockSync.GetRoundTripTime() / 1000.0 >= ClockStats.RoundTripTime)
+		{
+			ClockStats.ClockOffset = ClockSync.GetOffset() / 1000.0;
+			ClockStats.RoundTripTime = ClockSync.GetRoundTripTime() / 1000.0;
+		}
+	}
+
+	{
+		FScopeLock Lock(&StatsLock);
+		PublishedLatencyHistogram = LatencyHistogram;
+		PublishedClockStats = ClockStats;
+	}
+
+	LatencyHistogram.Reset();
+
+#if STATS
+	// The first receiver publishes the stats of all of them
+	if (Index == 0)
+	{
+		const FHoudiniLiveLinkLatencyStats Stats = Source.GetLatencyStats();
+		SET_FLOAT_STAT_FName(LatencyP50StatId.GetName(), Stats.P50);
+		SET_FLOAT_STAT_FName(LatencyP95StatId.GetName(), Stats.P95);
+		SET_FLOAT_STAT_FName(LatencyP99StatId.GetName(), Stats.P99);
+		SET_FLOAT_STAT_FName(RoundTripTimeStatId.GetName(), Stats.RoundTripTime);
+	}
+#endif
+}
+
+void
+FHoudiniLiveLinkReceiver::ProcessPong(FHoudiniLiveLinkSubjectState& Subject, const FHoudiniLiveLinkPacketHeader& Header, const char* Data, int32 DataSize, const FInternetAddr& SenderAddress, double Now)
+{
+	if (DataSize < (int32)sizeof(FHoudiniLiveLinkPingPayload))
+		return;
+
+	// A late pong from a sender that restarted (or was replaced) since has a different clock,
+	// it could become the minimum round trip sample and skew the offset
+	if (!Subject.LatencySenderAddress.IsValid() || !(*Subject.LatencySenderAddress == SenderAddress) || Header.StreamId != Subject.LatencyStreamId)
+		return;
+
+	FHoudiniLiveLinkPingPayload Pong;
+	FMemory::Memcpy(&Pong, Data, sizeof(Pong));
+	Subject.ClockSync.AddSample(Pong.ReceiverTime, Pong.SenderReceiveTime, Pong.SenderSendTime, ToMicroseconds(Now));
+}
+
+void
+FHoudiniLiveLinkReceiver::GetStreamStats(FHoudiniLiveLinkStreamStats& Stats) const
+{
+	FScopeLock Lock(&StatsLock);
+	for (const TPair<uint32, FHoudiniLiveLinkStreamStats>& Pair : StreamStats)
+	{
+		Stats.Received += Pair.Value.Received;
+		Stats.Lost += Pair.Value.Lost;
+		Stats.Late += Pair.Value.Late;
+		Stats.Duplicates += Pair.Value.Duplicates;
+		Stats.OutOfWindow += Pair.Value.OutOfWindow;
+		Stats.Resyncs += Pair.Value.Resyncs;
+	}
+}
+
+void
+FHoudiniLiveLinkReceiver::GetLatencyStats(FHoudiniLiveLinkLatencyHistogram& Histogram, FHoudiniLiveLinkLatencyStats& Stats) const
+{
+	FScopeLock Lock(&StatsLock);
+	Histogram.Merge(PublishedLatencyHistogram);
+	if (PublishedClockStats.RoundTripTime >= Stats.RoundTripTime)
+	{
+		Stats.ClockOffset = PublishedClockStats.ClockOffset;
+		Stats.RoundTripTime = PublishedClockStats.RoundTripTime;
+	}
+}
+
+bool
+FHoudiniLiveLinkReceiver::DecompressPayload(uint8 Compression, uint32 UncompressedSize, const char* Data, int32 DataSize)
+{
+	FName FormatName;
+	switch (Compression)
+	{
+		case HLL_COMPRESSION_ZLIB:
+			FormatName = NAME_Zlib;
+			break;
+
+		case HLL_COMPRESSION_LZ4:
+			FormatName = NAME_LZ4;
+			break;
+
+		default:
+			// Unknown codec
+			return false;
+	}
+
+	if (UncompressedSize == 0 || UncompressedSize > HOUDINI_LIVELINK_MAX_UNCOMPRESSED_SIZE)
+		return false;
+
+	// The buffer is reused between packets and only grows
+	DecompressionBuffer.SetNumUninitialized(UncompressedSize, false);
+	return FCompression::UncompressMemory(FormatName, DecompressionBuffer.GetData(), UncompressedSize, Data, DataSize);
+}
+
+void
+FHoudiniLiveLinkReceiver::CaptureFrame(const FHoudiniLiveLinkSubjectState& Subject, FLiveLinkAnimationFrameData&& FrameData, uint64 SendTime)
+{
+	FHoudiniLiveLinkCapturedFrame Frame;
+	Frame.Time = FPlatformTime::Seconds();
+	Frame.SendTime = SendTime;
+	Frame.SubjectName = Subject.SubjectName;
+	Frame.Skeleton = Subject.PushedStaticData;
+	Frame.Transforms = MoveTemp(FrameData.Transforms);
+	Frame.PropertyValues = MoveTemp(FrameData.PropertyValues);
+
+	// Never block the socket thread: drop the frame if the writer can't keep up
+	if (!CaptureQueue->Enqueue(MoveTemp(Frame)))
+		Source.CaptureDroppedFrames.Increment();
+}
+
+void
+FHoudiniLiveLinkReceiver::UpdateComponentSpacePose(const FHoudiniLiveLinkSubjectState& Subject, const FLiveLinkAnimationFrameData& FrameData)
+{
+	// Curves only frames keep the last pose
+	if (FrameData.Transforms.Num() != Subject.ComponentSpaceSolver.GetNumBones() || FrameData.Transforms.Num() <= 0)
+		return;
+
+	// Solve outside of the lock, readers only wait for the copy
+	Subject.ComponentSpaceSolver.Solve(FrameData.Transforms, ComponentSpaceTransforms);
+
+	FScopeLock Lock(&Source.ComponentSpacePosesLock);
+	FHoudiniLiveLinkComponentSpacePose& Pose = Source.ComponentSpacePoses.FindOrAdd(Subject.SubjectName);
+	Pose.Time = FPlatformTime::Seconds();
+	Pose.Skeleton = Subject.PushedStaticData;
+	Pose.Transforms = ComponentSpaceTransforms;
+}
+
+void
+FHoudiniLiveLinkSubjectState::GetLastFrameData(FLiveLinkAnimationFrameData& OutFrameData) const
+{
+	OutFrameData.Transforms.Reset();
+	if (bLastFrameHasTransforms)
+	{
+		if (SourceBoneMap.IsValid() && SourceTransforms.Num() > 0)
+			SourceBoneMap->Apply(SourceTransforms, OutFrameData.Transforms);
+		else
+			OutFrameData.Transforms = SourceTransforms;
+	}
+
+	OutFrameData.PropertyValues.Reset();
+	if (bLastFrameHasCurves)
+		OutFrameData.PropertyValues = CurveValues;
+}
+
+void
+FHoudiniLiveLinkReceiver::RefreshIdleSubject(FHoudiniLiveLinkSubjectState& Subject)
+{
+	const double Now = FPlatformTime::Seconds();
+	if ((Now - Subject.LastFramePushTime) < IdleRefreshDelay)
+		return;
+
+	if (!Source.IsSourceStillValid())
+		return;
+
+	// Push the last frame again, with a fresh world time
+	FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
+	FLiveLinkAnimationFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkAnimationFrameData>();
+	Subject.GetLastFrameData(FrameData);
+
+	Subject.LastFramePushTime = Now;
+	if (Source.Client)
+		Source.Client->PushSubjectFrameData_AnyThread({ Source.SourceGuid, Subject.SubjectName }, MoveTemp(FrameDataStruct));
+}
+
+bool 
+FHoudiniLiveLinkReceiver::ProcessResponseData(FHoudiniLiveLinkSubjectState& Subject, const FString& ReceivedData, uint64 FrameSkeletonHash, uint64 FrameSendTime)
+{
+	bFramePushed = false;
+
+	// No need to process the data if we're stopping
+	if(Source.Stopping)
+		return false;
+
+	TSharedPtr<FJsonObject> JsonObject;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ReceivedData);
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject))
+	{
+		// Whatever we received is not JSON
+		return false;
+	}
+
+	// Named subjects get their name with their static data, or from the cache if they were received before
+	if (Subject.SubjectName.IsNone())
+	{
+		FString Name;
+		if (JsonObject->TryGetStringField(TEXT("subject"), Name) && !Name.IsEmpty())
+			Subject.SubjectName = FName(*Name);
+		else
+			Subject.SubjectName = Source.SkeletonCache->FindSubjectName(Subject.SubjectId);
+
+		if (Subject.SubjectName.IsNone())
+			return true;
+	}
+
+	// Setup is done via GetSkeleton, and returns the following values:
+	// parents (Int Array), vertices (FVector Array), Names (String Array)
+
+	// Update is done via GetSkeletonPose, and has:
+	// position (FVector Array), rotations (FVector Array), Names (String Array)
+
+	// Static Data 
+	bool bStaticDataUpdated = false;
+	FHoudiniLiveLinkSkeleton NewSkeleton;
+	FLiveLinkSkeletonStaticData& StaticData = NewSkeleton.StaticData;
+
+	// Number of bones/curves of the frame data, used to find the skeleton it belongs to
+	int32 NumFrameBones = INDEX_NONE;
+	int32 NumFrameCurves = INDEX_NONE;
+	bool bFrameBonesMismatch = false;
+
+	// First pass: static data
+	for (TPair<FString, TSharedPtr<FJsonValue>>& JsonField : JsonObject->Values)
+	{
+		if (!JsonField.Value.IsValid() || JsonField.Value->Type != EJson::Array)
+			continue;
+
+		const TArray<TSharedPtr<FJsonValue>>& ValueArray = JsonField.Value->AsArray();
+		if (JsonField.Key.Equals(TEXT("parents"), ESearchCase::IgnoreCase))
+		{
+			// Parents (STATIC DATA) (GetSkeleton)
+			StaticData.BoneParents.SetNumUninitialized(ValueArray.Num());
+			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); BoneIdx++)
+			{
+				if (ValueArray[BoneIdx]->IsNull())
+				{
+					// Root Node
+					StaticData.BoneParents[BoneIdx] = -1;
+					NewSkeleton.Roots.Add(BoneIdx);
+				}
+				else
+				{
+					StaticData.BoneParents[BoneIdx] = (int32)ValueArray[BoneIdx]->AsNumber();
+				}
+			}
+
+			bStaticDataUpdated = true;
+		}
+		else if (JsonField.Key.Equals(TEXT("names"), ESearchCase::IgnoreCase))
+		{
+			// Names (STATIC DATA) (both)
+			StaticData.BoneNames.SetNumUninitialized(ValueArray.Num());
+			NewSkeleton.BoneNameStrings.SetNum(ValueArray.Num());
+
+			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); BoneIdx++)
+			{
+				NewSkeleton.BoneNameStrings[BoneIdx] = ValueArray[BoneIdx]->AsString();
+				StaticData.BoneNames[BoneIdx] = FName(*NewSkeleton.BoneNameStrings[BoneIdx]);
+			}
+
+			bStaticDataUpdated = true;
+		}
+		else if (JsonField.Key.Equals(TEXT("blendshape_names"), ESearchCase::IgnoreCase))
+		{
+			StaticData.PropertyNames.Empty(ValueArray.Num());
+			NewSkeleton.CurveNameStrings.Empty(ValueArray.Num());
+
+			for (int i = 0; i < ValueArray.Num(); ++i)
+			{
+				NewSkeleton.CurveNameStrings.Add(ValueArray[i]->AsString());
+				StaticData.PropertyNames.Add(FName(*NewSkeleton.CurveNameStrings[i]));
+			}
+
+			bStaticDataUpdated = true;
+		}
+		else if (JsonField.Key.Equals(TEXT("positions"), ESearchCase::IgnoreCase)
+			|| JsonField.Key.Equals(TEXT("rotations"), ESearchCase::IgnoreCase)
+			|| JsonField.Key.Equals(TEXT("scales"), ESearchCase::IgnoreCase))
+		{
+			if (NumFrameBones != INDEX_NONE && NumFrameBones != ValueArray.Num())
+				bFrameBonesMismatch = true;
+
+			NumFrameBones = ValueArray.Num();
+		}
+		else if (JsonField.Key.Equals(TEXT("blendshape_values"), ESearchCase::IgnoreCase))
+		{
+			NumFrameCurves = ValueArray.Num();
+		}
+	}
+
+	// Make sure the source is still valid before attempting to update the client data
+	if (!Source.IsSourceStillValid())
+		return false;
+
+	// Parents and names have to describe the same bones
+	if (bStaticDataUpdated && StaticData.BoneParents.Num() == StaticData.BoneNames.Num())
+	{
+		NewSkeleton.UpdateHash();
+		NewSkeleton.BoneMap = Source.GetBoneMap(NewSkeleton);
+
+		// The frame sent along with the static data must belong to it. If the hashes disagree, the sender
+		// doesn't hash the skeleton like we do and none of its frames would ever match: match them by counts.
+		const bool bHasFrameData = NumFrameBones != INDEX_NONE || NumFrameCurves != INDEX_NONE;
+		if (bHasFrameData && FrameSkeletonHash != 0 && FrameSkeletonHash != NewSkeleton.Hash && !Subject.bIgnoreSkeletonHash)
+		{
+			UE_LOG(LogHoudiniLiveLink, Warning, TEXT("Subject %s: the frames' skeleton hash (%016llx) doesn't match their static data (%016llx), matching frames by their number of bones and curves instead."),
+				*Subject.SubjectName.ToString(), (unsigned long long)FrameSkeletonHash, (unsigned long long)NewSkeleton.Hash);
+			Subject.bIgnoreSkeletonHash = true;
+		}
+
+		// Written once per subject/skeleton, for the next sessions
+		Source.SkeletonCache->Add(Subject.SubjectName, NewSkeleton);
+
+		if (Subject.SkeletonSetupNeeded)
+		{
+			// First skeleton, use it right away
+			Subject.CurrentSkeleton = MoveTemp(NewSkeleton);
+			Subject.bHasPendingSkeleton = false;
+			PushSkeleton(Subject, Subject.CurrentSkeleton);
+		}
+		else if (NewSkeleton.Hash == Subject.CurrentSkeleton.Hash)
+		{
+			// Houdini went back to the current skeleton before we received a frame for the pending one
+			Subject.bHasPendingSkeleton = false;
+		}
+		else if (!Subject.bHasPendingSkeleton || NewSkeleton.Hash != Subject.PendingSkeleton.Hash)
+		{
+			// The skeleton changed: keep it aside until we receive a frame that matches it,
+			// the current skeleton keeps receiving the frames that match it until then.
+			Subject.PendingSkeleton = MoveTemp(NewSkeleton);
+			Subject.bHasPendingSkeleton = true;
+		}
+	}
+
+	// No (valid) frame data
+	if (bFrameBonesMismatch || (NumFrameBones == INDEX_NONE && NumFrameCurves == INDEX_NONE))
+		return true;
+
+	if (Subject.bIgnoreSkeletonHash)
+		FrameSkeletonHash = 0;
+
+	if (Subject.bHasPendingSkeleton && Subject.PendingSkeleton.MatchesFrame(FrameSkeletonHash, NumFrameBones, NumFrameCurves))
+	{
+		// Swap the pending skeleton in along with the first frame that matches it
+		Subject.CurrentSkeleton = MoveTemp(Subject.PendingSkeleton);
+		Subject.bHasPendingSkeleton = false;
+		PushSkeleton(Subject, Subject.CurrentSkeleton);
+	}
+	else if (Subject.SkeletonSetupNeeded || !Subject.CurrentSkeleton.MatchesFrame(FrameSkeletonHash, NumFrameBones, NumFrameCurves))
+	{
+		// Frame from a skeleton we don't have yet: use it right away if a previous session cached it,
+		// otherwise wait for its static data. Frames without a skeleton hash can't be identified.
+		const FHoudiniLiveLinkSkeleton* CachedSkeleton = FrameSkeletonHash != 0 ? Source.SkeletonCache->Find(Subject.SubjectName, FrameSkeletonHash) : nullptr;
+		if (!CachedSkeleton || !CachedSkeleton->MatchesFrame(FrameSkeletonHash, NumFrameBones, NumFrameCurves))
+			return true;
+
+		Subject.CurrentSkeleton = *CachedSkeleton;
+		Subject.CurrentSkeleton.BoneMap = Source.GetBoneMap(Subject.CurrentSkeleton);
+		PushSkeleton(Subject, Subject.CurrentSkeleton);
+	}
+
+	const FHoudiniLiveLinkSkeleton& Skeleton = Subject.CurrentSkeleton;
+
+	// Frame Data
+	bool bFrameDataUpdated = false;
+	FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
+	FLiveLinkAnimationFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkAnimationFrameData>();
+
+	// The transforms are parsed into the subject's buffer, it keeps them for the idle refreshes
+	TArray<FTransform>& Transforms = Subject.SourceTransforms;
+	if (NumFrameBones != INDEX_NONE)
+	{
+		Transforms.Init(FTransform::Identity, NumFrameBones);
+		Subject.SourceBoneMap = Skeleton.BoneMap;
+	}
+
+	// Curves can be sent as a delta against the last full curve frame, identified by its key
+	int32 CurveKey = INDEX_NONE;
+	JsonObject->TryGetNumberField(TEXT("blendshape_key"), CurveKey);
+	const TArray<TSharedPtr<FJsonValue>>* DeltaIndices = nullptr;
+	const TArray<TSharedPtr<FJsonValue>>* DeltaValues = nullptr;
+	bool bCurvesUpdated = false;
+
+	// Second pass: frame data
+	for (TPair<FString, TSharedPtr<FJsonValue>>& JsonField : JsonObject->Values)
+	{
+		if (!JsonField.Value.IsValid() || JsonField.Value->Type != EJson::Array)
+			continue;
+
+		const TArray<TSharedPtr<FJsonValue>>& ValueArray = JsonField.Value->AsArray();
+		if (JsonField.Key.Equals(TEXT("positions"), ESearchCase::IgnoreCase))
+		{
+			// positions (FRAME DATA) (GetSkeletonPose)
+			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); ++BoneIdx)
+			{
+				const TArray<TSharedPtr<FJsonValue>>& LocationArray = ValueArray[BoneIdx]->AsArray();
+
+				FVector BoneLocation = FVector::ZeroVector;
+				if ( LocationArray.Num() == 3) // X, Y, Z
+				{
+					double X = LocationArray[0]->AsNumber();
+					double Y = LocationArray[1]->AsNumber();
+					double Z = LocationArray[2]->AsNumber();
+
+					// Houdini to Unreal: Swap Y/Z, meters to cm
+					BoneLocation = FVector(X, -Y, Z) * TransformScale;
+				}
+				Transforms[BoneIdx].SetLocation(BoneLocation);
+			}
+
+			bFrameDataUpdated = true;
+		}
+		else if (JsonField.Key.Equals(TEXT("rotations"), ESearchCase::IgnoreCase))
+		{
+			// rotations (FRAME DATA) (GetSkeletonPose)
+			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); ++BoneIdx)
+			{
+				const TArray<TSharedPtr<FJsonValue>>& RotationArray = ValueArray[BoneIdx]->AsArray();
+
+				FQuat HQuat = FQuat::Identity;
+				if (RotationArray.Num() == 3)
+				{
+					double X = RotationArray[0]->AsNumber();
+					double Y = RotationArray[1]->AsNumber();
+					double Z = RotationArray[2]->AsNumber();
+
+					HQuat = FQuat::MakeFromEuler(FVector(X, -Y, -Z));
+				}
+				else if (RotationArray.Num() == 4)
+				{
+					// TODO: untested, the livelink HDA doesnot send quaternions for now
+					double X = RotationArray[0]->AsNumber();
+					double Y = RotationArray[1]->AsNumber();
+					double Z = RotationArray[2]->AsNumber();
+					double W = RotationArray[3]->AsNumber();
+					HQuat = FQuat(X, Z, Y, -W);
+				}
+
+				Transforms[BoneIdx].SetRotation(HQuat);
+				if (Skeleton.Roots.Contains(BoneIdx))
+				{
+					FTransform rotate(FQuat::MakeFromEuler(FVector(90.0f, 0, 0)));
+					Transforms[BoneIdx] = Transforms[BoneIdx] * rotate;
+				}
+			}
+
+			bFrameDataUpdated = true;
+		}
+		else if (JsonField.Key.Equals(TEXT("scales"), ESearchCase::IgnoreCase))
+		{
+			// scale (FRAME DATA) (GetSkeletonPose)
+			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); ++BoneIdx)
+			{
+				const TArray<TSharedPtr<FJsonValue>>& ScaleArray = ValueArray[BoneIdx]->AsArray();
+
+				FVector BoneScale = FVector::OneVector;
+				if (ScaleArray.Num() == 3) // X, Y, Z
+				{
+					double X = ScaleArray[0]->AsNumber();
+					double Y = ScaleArray[1]->AsNumber();
+					double Z = ScaleArray[2]->AsNumber();
+
+					// Houdini to Unreal: Swap Y/Z
+					BoneScale = FVector(X, Z, Y);
+				}
+
+				Transforms[BoneIdx].SetScale3D(BoneScale);
+			}
+
+			bFrameDataUpdated = true;
+		}
+		else if (JsonField.Key.Equals(TEXT("blendshape_values"), ESearchCase::IgnoreCase))
+		{
+			// Full curve frame, becomes the base for the following deltas
+			Subject.CurveValues.SetNumUninitialized(ValueArray.Num(), false);
+			for (int i = 0; i < ValueArray.Num(); ++i)
+			{
+				Subject.CurveValues[i] = ValueArray[i]->AsNumber();
+			}
+
+			Subject.BaseCurveValues = Subject.CurveValues;
+			Subject.BaseCurveKey = CurveKey;
+			Subject.PatchedCurveIndices.Reset();
+
+			bCurvesUpdated = true;
+			bFrameDataUpdated = true;
+		}
+		else if (JsonField.Key.Equals(TEXT("blendshape_delta_indices"), ESearchCase::IgnoreCase))
+		{
+			DeltaIndices = &ValueArray;
+		}
+		else if (JsonField.Key.Equals(TEXT("blendshape_delta_values"), ESearchCase::IgnoreCase))
+		{
+			DeltaValues = &ValueArray;
+		}
+	}
+
+	// Pushed transforms, reordered/trimmed to the target layout
+	if (NumFrameBones != INDEX_NONE)
+	{
+		if (Skeleton.BoneMap.IsValid() && Transforms.Num() > 0)
+			Skeleton.BoneMap->Apply(Transforms, FrameData.Transforms);
+		else
+			FrameData.Transforms = Transforms;
+	}
+
+	if (DeltaIndices && DeltaValues && DeltaIndices->Num() == DeltaValues->Num())
+	{
+		// A delta can only be applied on top of the full frame it was computed against,
+		// if we missed that frame, keep the current values until the next full frame.
+		if (CurveKey != INDEX_NONE && CurveKey == Subject.BaseCurveKey)
+		{
+			// Undo the previous delta, then patch the values that differ from the base
+			for (int32 CurveIdx : Subject.PatchedCurveIndices)
+			{
+				Subject.CurveValues[CurveIdx] = Subject.BaseCurveValues[CurveIdx];
+			}
+			Subject.PatchedCurveIndices.Reset();
+
+			for (int i = 0; i < DeltaIndices->Num(); ++i)
+			{
+				int32 CurveIdx = (int32)(*DeltaIndices)[i]->AsNumber();
+				if (!Subject.CurveValues.IsValidIndex(CurveIdx))
+					continue;
+
+				Subject.CurveValues[CurveIdx] = (*DeltaValues)[i]->AsNumber();
+				Subject.PatchedCurveIndices.Add(CurveIdx);
+			}
+
+			bCurvesUpdated = true;
+		}
+
+		bFrameDataUpdated = true;
+	}
+
+	const bool bHasCurves = bFrameDataUpdated && (bCurvesUpdated || Subject.CurveValues.Num() == Skeleton.GetNumCurves());
+	if (bHasCurves)
+	{
+		FrameData.PropertyValues = Subject.CurveValues;
+	}
+
+	if (bFrameDataUpdated)
+	{
+		if (Source.bCapturing)
+			CaptureFrame(Subject, FLiveLinkAnimationFrameData(FrameData), FrameSendTime);
+
+		if (Source.Options.bComputeComponentSpace)
+			UpdateComponentSpacePose(Subject, FrameData);
+
+		// No copy of the frame is kept, the subject rebuilds it from its transforms and curves
+		Subject.bLastFrameHasTransforms = NumFrameBones != INDEX_NONE;
+		Subject.bLastFrameHasCurves = bHasCurves;
+		Subject.LastFramePushTime = FPlatformTime::Seconds();
+		bFramePushed = true;
+
+		// Packets can arrive before LiveLink gives us its client
+		if (Source.Client)
+			Source.Client->PushSubjectFrameData_AnyThread({ Source.SourceGuid, Subject.SubjectName }, MoveTemp(FrameDataStruct));
+	}
+
+	return true;
+}
+
+void
+FHoudiniLiveLinkReceiver::PushSkeleton(FHoudiniLiveLinkSubjectState& Subject, const FHoudiniLiveLinkSkeleton& Skeleton)
+{
+	Subject.SkeletonSetupNeeded = false;
+
+	// Curve deltas computed against the previous curves can't be applied anymore
+	if (Subject.CurveValues.Num() != Skeleton.GetNumCurves())
+	{
+		Subject.BaseCurveKey = INDEX_NONE;
+		Subject.CurveValues.Reset();
+		Subject.BaseCurveValues.Reset();
+		Subject.PatchedCurveIndices.Reset();
+	}
+
+	FLiveLinkStaticDataStruct StaticDataStruct = FLiveLinkStaticDataStruct(FLiveLinkSkeletonStaticData::StaticStruct());
+	FLiveLinkSkeletonStaticData& StaticData = *StaticDataStruct.Cast<FLiveLinkSkeletonStaticData>();
+	StaticData = Skeleton.StaticData;
+	if (Skeleton.BoneMap.IsValid())
+	{
+		StaticData.BoneNames = Skeleton.BoneMap->BoneNames;
+		StaticData.BoneParents = Skeleton.BoneMap->BoneParents;
+	}
+
+	if (CaptureQueue.IsValid() || Source.Options.bComputeComponentSpace)
+		Subject.PushedStaticData = MakeShared<FLiveLinkSkeletonStaticData, ESPMode::ThreadSafe>(StaticData);
+
+	// Sort the bones once here rather than walking the parents for every frame
+	if (Source.Options.bComputeComponentSpace)
+		Subject.ComponentSpaceSolver.Init(StaticData.BoneParents);
+
+	if (Source.Client)
+		Source.Client->PushSubjectStaticData_AnyThread({ Source.SourceGuid, Subject.SubjectName }, ULiveLinkAnimationRole::StaticClass(), MoveTemp(StaticDataStruct));
+}
+
+void
+FHoudiniLiveLinkComponentSpaceSolver::Init(const TArray<int32>& BoneParents)
+{
+	const int32 NumBones = BoneParents.Num();
+	Order.Reset(NumBones);
+	OrderParents.Reset(NumBones);
+
+	// Parents usually come first already, the order is then just the bone order
+	bool bSorted = true;
+	for (int32 BoneIdx = 0; BoneIdx < NumBones && bSorted; ++BoneIdx)
+	{
+		bSorted = BoneParents[BoneIdx] < BoneIdx;
+	}
+
+	if (bSorted)
+	{
+		for (int32 BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+		{
+			Order.Add(BoneIdx);
+			OrderParents.Add(BoneParents.IsValidIndex(BoneParents[BoneIdx]) ? BoneParents[BoneIdx] : INDEX_NONE);
+		}
+		return;
+	}
+
+	// Depth first from the roots, so chains of bones stay next to each other
+	TArray<TArray<int32>> Children;
+	Children.SetNum(NumBones);
+	TArray<int32> Stack;
+	for (int32 BoneIdx = NumBones - 1; BoneIdx >= 0; --BoneIdx)
+	{
+		if (BoneParents.IsValidIndex(BoneParents[BoneIdx]))
+			Children[BoneParents[BoneIdx]].Insert(BoneIdx, 0);
+		else
+			Stack.Add(BoneIdx);
+	}
+
+	TBitArray<> Visited(false, NumBones);
+	auto Visit = [&]()
+	{
+		while (Stack.Num() > 0)
+		{
+			const int32 BoneIdx = Stack.Pop(false);
+			Visited[BoneIdx] = true;
+			Order.Add(BoneIdx);
+			OrderParents.Add(BoneParents.IsValidIndex(BoneParents[BoneIdx]) && Visited[BoneParents[BoneIdx]] ? BoneParents[BoneIdx] : INDEX_NONE);
+
+			for (int32 ChildIdx = Children[BoneIdx].Num() - 1; ChildIdx >= 0; --ChildIdx)
+			{
+				if (!Visited[Children[BoneIdx][ChildIdx]])
+					Stack.Add(Children[BoneIdx][ChildIdx]);
+			}
+		}
+	};
+	Visit();
+
+	// Bones in a parent loop aren't reachable from a root, treat them as roots
+	for (int32 BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+	{
+		if (Visited[BoneIdx])
+			continue;
+
+		Stack.Add(BoneIdx);
+		Visit();
+	}
+}
+
+void
+FHoudiniLiveLinkComponentSpaceSolver::Solve(const TArray<FTransform>& LocalTransforms, TArray<FTransform>& OutComponentTransforms) const
+{
+	const int32 NumBones = Order.Num();
+	OutComponentTransforms.SetNumUninitialized(NumBones, false);
+
+	const FTransform* Local = LocalTransforms.GetData();
+	FTransform* Component = OutComponentTransforms.GetData();
+	for (int32 OrderIdx = 0; OrderIdx < NumBones; ++OrderIdx)
+	{
+		const int32 BoneIdx = Order[OrderIdx];
+		const int32 Parent = OrderParents[OrderIdx];
+		if (Parent == INDEX_NONE)
+			Component[BoneIdx] = Local[BoneIdx];
+		else
+			FTransform::Multiply(&Component[BoneIdx], &Local[BoneIdx], &Component[Parent]);
+	}
+}
+
+void
+FHoudiniLiveLinkSkeleton::UpdateHash()
+{
+	// Same hash as the senders, over the names as they were received
+	TArray<ANSICHAR> Utf8Name;
+	auto GetName = [&Utf8Name](const TArray<FString>& Names, int32 Index, int32& OutLength)
+	{
+		FTCHARToUTF8 Name(*Names[Index]);
+		Utf8Name.SetNumUninitialized(Name.Length());
+		FMemory::Memcpy(Utf8Name.GetData(), Name.Get(), Name.Length());
+		OutLength = Name.Length();
+		return (const char*)Utf8Name.GetData();
+	};
+
+	Hash = HoudiniLiveLinkHashSkeleton(
+		BoneNameStrings.Num(), [&](int32 Index, int32& OutLength) { return GetName(BoneNameStrings, Index, OutLength); },
+		StaticData.BoneParents.GetData(),
+		CurveNameStrings.Num(), [&](int32 Index, int32& OutLength) { return GetName(CurveNameStrings, Index, OutLength); });
+}
+
+bool
+FHoudiniLiveLinkSkeleton::MatchesFrame(uint64 FrameSkeletonHash, int32 NumFrameBones, int32 NumFrameCurves) const
+{
+	// Frames that carry the hash of their skeleton are matched exactly, others by their number of bones/curves
+	if (FrameSkeletonHash != 0 && FrameSkeletonHash != Hash)
+		return false;
+
+	if (NumFrameBones != INDEX_NONE && NumFrameBones != GetNumBones())
+		return false;
+
+	if (NumFrameCurves != INDEX_NONE && NumFrameCurves != GetNumCurves())
+		return false;
+
+	return true;
+}
+
+bool
+FHoudiniLiveLinkSequenceTracker::Accept(uint32 StreamId, uint32 Sequence)
+{
+	if (!bInitialized || StreamId != LastStreamId)
+	{
+		// First frame, or Houdini restarted the stream
+		Resync(StreamId, Sequence);
+		return true;
+	}
+
+	// Signed difference handles the sequence wrapping around
+	const int32 Delta = (int32)(Sequence - LastSequence);
+	if (Delta > 0)
+	{
+		// Frames leaving the window without having been received are lost
+		const uint64 Missing = WindowMask & ~ReceivedMask;
+		if (Delta < WindowSize)
+		{
+			Stats.Lost += FMath::CountBits(Missing >> (WindowSize - Delta));
+			ReceivedMask = (ReceivedMask << Delta) | 1;
+			WindowMask = (WindowMask << Delta) | (((uint64)1 << Delta) - 1);
+		}
+		else
+		{
+			// The frames in between are too old to enter the window
+			Stats.Lost += FMath::CountBits(Missing) + (Delta - WindowSize);
+			ReceivedMask = 1;
+			WindowMask = ~(uint64)0;
+		}
+
+		LastSequence = Sequence;
+		NumRejectedFrames = 0;
+		Stats.Received++;
+		return true;
+	}
+
+	const int64 Age = -(int64)Delta;
+	const uint64 Bit = Age < WindowSize ? (uint64)1 << Age : 0;
+	if (Bit && !(ReceivedMask & Bit))
+	{
+		// Reordered, it is no longer missing
+		ReceivedMask |= Bit;
+		Stats.Late++;
+		return false;
+	}
+
+	// Duplicate or out of window frame: a run of them, moving forward, comes from a restarted sender
+	if (NumRejectedFrames > 0 && (int32)(Sequence - LastRejectedSequence) > 0)
+		NumRejectedFrames++;
+	else
+		NumRejectedFrames = 1;
+
+	LastRejectedSequence = Sequence;
+	if (NumRejectedFrames >= ResyncRejectedFrames)
+	{
+		Resync(StreamId, Sequence);
+		return true;
+	}
+
+	if (Bit)
+		Stats.Duplicates++;
+	else
+		Stats.OutOfWindow++;
+
+	return false;
+}
+
+void
+FHoudiniLiveLinkSequenceTracker::Resync(uint32 StreamId, uint32 Sequence)
+{
+	if (bInitialized)
+		Stats.Resyncs++;
+
+	bInitialized = true;
+	LastStreamId = StreamId;
+	LastSequence = Sequence;
+	ReceivedMask = 1;
+	WindowMask = 1;
+	NumRejectedFrames = 0;
+	Stats.Received++;
+}
+
+void
+FHoudiniLiveLinkClockSync::AddSample(uint64 PingSendTime, uint64 SenderReceiveTime, uint64 SenderSendTime, uint64 PongReceiveTime)
+{
+	// The clocks are unrelated, only differences between times of the same clock are meaningful
+	const int64 Outbound = (int64)(SenderReceiveTime - PingSendTime);
+	const int64 Inbound = (int64)(SenderSendTime - PongReceiveTime);
+	const int64 RoundTripTime = (int64)(PongReceiveTime - PingSendTime) - (int64)(SenderSendTime - SenderReceiveTime);
+	if (RoundTripTime < 0)
+		return;
+
+	Samples[NextSample].Offset = (Outbound + Inbound) / 2;
+	Samples[NextSample].RoundTripTime = RoundTripTime;
+	NextSample = (NextSample + 1) % MaxSamples;
+	NumSamples = FMath::Min(NumSamples + 1, MaxSamples);
+}
+
+int32
+FHoudiniLiveLinkClockSync::GetBestSample() const
+{
+	int32 BestSample = 0;
+	for (int32 SampleIdx = 1; SampleIdx < NumSamples; ++SampleIdx)
+	{
+		if (Samples[SampleIdx].RoundTripTime < Samples[BestSample].RoundTripTime)
+			BestSample = SampleIdx;
+	}
+	return BestSample;
+}
+
+int64
+FHoudiniLiveLinkClockSync::GetOffset() const
+{
+	return NumSamples > 0 ? Samples[GetBestSample()].Offset : 0;
+}
+
+int64
+FHoudiniLiveLinkClockSync::GetRoundTripTime() const
+{
+	return NumSamples > 0 ? Samples[GetBestSample()].RoundTripTime : 0;
+}
+
+void
+FHoudiniLiveLinkLatencyHistogram::Add(double LatencyMs)
+{
+	// Negative latencies come from the clock offset error
+	const int32 Bucket = FMath::Clamp((int32)(LatencyMs / BucketSize), 0, NumBuckets - 1);
+	Buckets[Bucket]++;
+	NumSamples++;
+}
+
+double
+FHoudiniLiveLinkLatencyHistogram::GetPercentile(double Percentile) const
+{
+	if (NumSamples <= 0)
+		return 0.0;
+
+	const int64 Target = FMath::Max<int64>(1, (int64)FMath::CeilToDouble(Percentile * NumSamples));
+	int64 Count = 0;
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Count += Buckets[Bucket];
+		if (Count >= Target)
+			return (Bucket + 1) * BucketSize;
+	}
+
+	return NumBuckets * BucketSize;
+}
+
+void
+FHoudiniLiveLinkLatencyHistogram::Merge(const FHoudiniLiveLinkLatencyHistogram& Other)
+{
+	for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+	{
+		Buckets[Bucket] += Other.Buckets[Bucket];
+	}
+	NumSamples += Other.NumSamples;
+}
+
+void
+FHoudiniLiveLinkLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets);
+	NumSamples = 0;
+}
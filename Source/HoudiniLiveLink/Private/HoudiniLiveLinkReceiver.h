@@ -0,0 +1,401 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "HoudiniLiveLinkSource.h"
+
+#include "HAL/Runnable.h"
+#include "Stats/Stats.h"
+
+class FInternetAddr;
+struct FHoudiniLiveLinkPacketHeader;
+class FRunnableThread;
+class FSocket;
+
+// Converts local transforms to component space in a single pass over the bones
+struct FHoudiniLiveLinkComponentSpaceSolver
+{
+	// Bones sorted so that parents come before their children, and the parent of each of them (INDEX_NONE for roots)
+	TArray<int32> Order;
+	TArray<int32> OrderParents;
+
+	// Sorts the bones once, when the skeleton changes
+	void Init(const TArray<int32>& BoneParents);
+
+	// Local and component space transforms are in the skeleton's bone order
+	void Solve(const TArray<FTransform>& LocalTransforms, TArray<FTransform>& OutComponentTransforms) const;
+
+	int32 GetNumBones() const { return Order.Num(); }
+};
+
+// Skeleton received from Houdini, along with the tables needed to convert its frames
+struct FHoudiniLiveLinkSkeleton
+{
+	FLiveLinkSkeletonStaticData StaticData;
+
+	// Bone/curve names as they were received, FNames don't always keep their case.
+	// The hash and the cache use these.
+	TArray<FString> BoneNameStrings;
+	TArray<FString> CurveNameStrings;
+
+	// Root bones, their rotation needs to be converted to Unreal's up axis
+	TSet<int32> Roots;
+
+	// Hash of the names/parents/curve names, used to detect skeleton changes
+	uint64 Hash = 0;
+
+	// Remapping to the target layout, null if frames are pushed as they are received
+	TSharedPtr<const FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe> BoneMap;
+
+	int32 GetNumBones() const { return StaticData.BoneNames.Num(); }
+	int32 GetNumCurves() const { return StaticData.PropertyNames.Num(); }
+
+	void UpdateHash();
+
+	// Indicates if a frame with the given skeleton hash (0 if unknown) and number of bones/curves (INDEX_NONE if absent)
+	// can be applied to this skeleton
+	bool MatchesFrame(uint64 FrameSkeletonHash, int32 NumFrameBones, int32 NumFrameCurves) const;
+};
+
+// Estimates the offset between the sender and receiver clocks from ping/pong exchanges.
+// The sample with the smallest round trip among the recent ones is the least affected by queuing.
+class FHoudiniLiveLinkClockSync
+{
+	public:
+
+		// Times in microseconds: ping sent (receiver clock), ping received and pong sent (sender clock), pong received (receiver clock)
+		void AddSample(uint64 PingSendTime, uint64 SenderReceiveTime, uint64 SenderSendTime, uint64 PongReceiveTime);
+
+		bool HasOffset() const { return NumSamples > 0; }
+
+		// Sender clock minus receiver clock, in microseconds
+		int64 GetOffset() const;
+		int64 GetRoundTripTime() const;
+
+		void Reset() { NumSamples = 0; NextSample = 0; }
+
+	private:
+
+		struct FSample
+		{
+			int64 Offset;
+			int64 RoundTripTime;
+		};
+
+		static const int32 MaxSamples = 16;
+		FSample Samples[MaxSamples];
+		int32 NumSamples = 0;
+		int32 NextSample = 0;
+
+		int32 GetBestSample() const;
+};
+
+// Fixed size latency histogram, with 0.1ms buckets up to 250ms
+class FHoudiniLiveLinkLatencyHistogram
+{
+	public:
+
+		FHoudiniLiveLinkLatencyHistogram() { Reset(); }
+
+		void Add(double LatencyMs);
+
+		// Adds the samples of another histogram to this one
+		void Merge(const FHoudiniLiveLinkLatencyHistogram& Other);
+
+		// Returns the latency (in ms) below which Percentile (0-1) of the samples are
+		double GetPercentile(double Percentile) const;
+
+		int64 GetNumSamples() const { return NumSamples; }
+
+		void Reset();
+
+	private:
+
+		static const int32 NumBuckets = 2500;
+		static const double BucketSize;
+
+		// The last bucket also counts everything above the range
+		uint32 Buckets[NumBuckets];
+		int64 NumSamples;
+};
+
+// Tracks the sequence numbers of a subject's stream to reject stale/duplicate frames
+class FHoudiniLiveLinkSequenceTracker
+{
+	public:
+
+		// Returns true if the frame is newer than every frame seen so far and should be applied
+		bool Accept(uint32 StreamId, uint32 Sequence);
+
+		void Reset() { bInitialized = false; }
+
+		const FHoudiniLiveLinkStreamStats& GetStats() const { return Stats; }
+
+	private:
+
+		void Resync(uint32 StreamId, uint32 Sequence);
+
+		bool bInitialized = false;
+
+		uint32 LastStreamId = 0;
+		uint32 LastSequence = 0;
+
+		// Bit N is set if LastSequence - N has been received
+		uint64 ReceivedMask = 0;
+
+		// Bit N is set if LastSequence - N belongs to the stream (isn't older than its first frame)
+		uint64 WindowMask = 0;
+
+		// Number of duplicate/out of window frames received in a row, each newer than the previous one
+		int32 NumRejectedFrames = 0;
+		uint32 LastRejectedSequence = 0;
+
+		FHoudiniLiveLinkStreamStats Stats;
+
+		// Number of frames tracked by the masks
+		static const int32 WindowSize = 64;
+
+		// A sender restarting without changing its stream id sends frames we already saw, or older ones:
+		// they're all rejected, in increasing order. That many in a row resync the stream.
+		static const int32 ResyncRejectedFrames = 8;
+};
+
+// State of one subject's stream, owned by the receive thread its packets arrive on
+struct FHoudiniLiveLinkSubjectState
+{
+	// Id from the packet headers, 0 for the source's subject
+	uint32 SubjectId = 0;
+
+	// None until a packet names the subject
+	FName SubjectName;
+
+	// Indicates that the skeleton needs to be setup from houdini first
+	bool SkeletonSetupNeeded = true;
+
+	// Skeleton currently used by the subject
+	FHoudiniLiveLinkSkeleton CurrentSkeleton;
+
+	// New skeleton received from Houdini, swapped in with the first frame that matches it
+	FHoudiniLiveLinkSkeleton PendingSkeleton;
+	bool bHasPendingSkeleton = false;
+
+	// Values of the last full curve frame, curve deltas are relative to it
+	TArray<float> BaseCurveValues;
+
+	// Current curve values, patched in place by the deltas
+	TArray<float> CurveValues;
+
+	// Curves modified by the last delta, restored from the base before applying the next one
+	TArray<int32> PatchedCurveIndices;
+
+	// Key of the last full curve frame, INDEX_NONE if none was received
+	int32 BaseCurveKey = INDEX_NONE;
+
+	// Hash/size of the last payload that resulted in a frame being pushed.
+	// Identical payloads are skipped before being parsed.
+	uint64 LastPayloadHash = 0;
+	int32 LastPayloadSize = -1;
+
+	// Transforms of the last frame in the Houdini layout, parsed in place, and the bone map they're pushed through.
+	// With CurveValues, they rebuild the last pushed frame, see GetLastFrameData().
+	TArray<FTransform> SourceTransforms;
+	TSharedPtr<const FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe> SourceBoneMap;
+	bool bLastFrameHasTransforms = false;
+	bool bLastFrameHasCurves = false;
+
+	// Time of the last frame push (in seconds)
+	double LastFramePushTime = 0.0;
+
+	// Sequence numbers of the subject's stream, only used if packets have a header
+	FHoudiniLiveLinkSequenceTracker SequenceTracker;
+
+	// Latency measurement, only for senders that timestamp their frames
+	TSharedPtr<FInternetAddr> LatencySenderAddress;
+	uint32 LatencyStreamId = 0;
+	FHoudiniLiveLinkClockSync ClockSync;
+	double LastPingTime = 0.0;
+
+	// Time of the last timestamped frame, the sender is only pinged while its frames arrive
+	double LastTimestampedFrameTime = 0.0;
+
+	// Set once the frames' skeleton hash was found to differ from their static data's,
+	// the frames are then matched by their number of bones/curves
+	bool bIgnoreSkeletonHash = false;
+
+	// Static data of the current skeleton, as pushed, referenced by the captured frames and component space poses
+	TSharedPtr<const FLiveLinkSkeletonStaticData, ESPMode::ThreadSafe> PushedStaticData;
+
+	// Bone order of the current skeleton for the component space pass
+	FHoudiniLiveLinkComponentSpaceSolver ComponentSpaceSolver;
+
+	// Time of the last packet received for the subject (in seconds)
+	double LastPacketTime = 0.0;
+
+	// Last pushed frame, used to keep the subject alive when idle and to capture the held frames
+	void GetLastFrameData(FLiveLinkAnimationFrameData& OutFrameData) const;
+};
+
+// Receives and decodes the packets of one socket bound to the source's port.
+// With several receivers, the system spreads the senders between their sockets: every packet
+// of a sender reaches the same receiver, so each subject is decoded in order by a single thread.
+class FHoudiniLiveLinkReceiver : public FRunnable
+{
+	public:
+
+		FHoudiniLiveLinkReceiver(FHoudiniLiveLinkSource& InSource, int32 InIndex);
+
+		virtual ~FHoudiniLiveLinkReceiver();
+
+		// Begin FRunnable Interface
+
+		virtual bool Init() override { return true; }
+		virtual uint32 Run() override;
+		void Start();
+		virtual void Stop() override;
+		virtual void Exit() override { }
+
+		// End FRunnable Interface
+
+		bool IsRunning() const { return Thread != nullptr; }
+
+		// Handles a packet received from SenderAddress. Called by the receive thread, or directly on a receiver
+		// that wasn't started (the tests feed it encoded packets).
+		void ProcessPacket(const char* Packet, int32 PacketSize, const FInternetAddr& SenderAddress, double Now);
+
+		// Returns the state of a subject, null if no packet was received for it
+		const FHoudiniLiveLinkSubjectState* FindSubject(uint32 SubjectId) const;
+
+		// FrameSkeletonHash and FrameSendTime come from the packet header, 0 if unknown
+		bool ProcessResponseData(FHoudiniLiveLinkSubjectState& Subject, const FString& ReceivedData, uint64 FrameSkeletonHash = 0, uint64 FrameSendTime = 0);
+
+		// Stats of the subjects received by this thread, summed into Stats
+		void GetStreamStats(FHoudiniLiveLinkStreamStats& Stats) const;
+
+		// Latency samples of the last measurement window, merged into Histogram.
+		// Also returns the clock sync of the subject with the longest round trip.
+		void GetLatencyStats(FHoudiniLiveLinkLatencyHistogram& Histogram, FHoudiniLiveLinkLatencyStats& Stats) const;
+
+		// Capture buffer of this thread, null if capture is disabled. Only read by a single thread at a time.
+		TCircularQueue<FHoudiniLiveLinkCapturedFrame>* GetCaptureQueue() const { return CaptureQueue.Get(); }
+
+	private:
+
+		// Returns the state of a subject, created on its first packet. Null if there are too many subjects.
+		FHoudiniLiveLinkSubjectState* GetSubject(uint32 SubjectId, double Now);
+
+		// Forgets the subjects that stopped sending
+		void ExpireSubjects(double Now);
+
+		// Decompresses a payload into DecompressionBuffer
+		bool DecompressPayload(uint8 Compression, uint32 UncompressedSize, const char* Data, int32 DataSize);
+
+		// Pushes the static data of the skeleton to LiveLink
+		void PushSkeleton(FHoudiniLiveLinkSubjectState& Subject, const FHoudiniLiveLinkSkeleton& Skeleton);
+
+		// Sends pings to the senders and publishes the latency stats when needed
+		void UpdateLatency(FSocket* Socket, double Now);
+
+		// Handles a pong received for a subject, ignored unless it comes from its current sender and stream
+		void ProcessPong(FHoudiniLiveLinkSubjectState& Subject, const FHoudiniLiveLinkPacketHeader& Header, const char* Data, int32 DataSize, const FInternetAddr& SenderAddress, double Now);
+
+		// Computes and publishes the component space pose of a frame
+		void UpdateComponentSpacePose(const FHoudiniLiveLinkSubjectState& Subject, const FLiveLinkAnimationFrameData& FrameData);
+
+		// Adds a frame to the capture buffer
+		void CaptureFrame(const FHoudiniLiveLinkSubjectState& Subject, FLiveLinkAnimationFrameData&& FrameData, uint64 SendTime);
+
+		// Re-push the last frame so the subject stays alive while Houdini is idle
+		void RefreshIdleSubject(FHoudiniLiveLinkSubjectState& Subject);
+
+		FHoudiniLiveLinkSource& Source;
+
+		// Index of the receiver in the source
+		int32 Index;
+
+		// Thread to run socket operations on
+		FRunnableThread* Thread;
+
+		// Name of the sockets thread
+		FString ThreadName;
+
+		// Subjects received by this thread, by subject id
+		TMap<uint32, FHoudiniLiveLinkSubjectState> Subjects;
+		double LastExpireTime;
+
+		// Indicates that the last call to ProcessResponseData pushed frame data
+		bool bFramePushed;
+
+		// Reusable buffer for the decompressed payloads
+		TArray<uint8> DecompressionBuffer;
+
+		// Reusable buffer for the component space transforms
+		TArray<FTransform> ComponentSpaceTransforms;
+
+		// Latency samples of all the subjects, for the current measurement window
+		FHoudiniLiveLinkLatencyHistogram LatencyHistogram;
+		double LatencyWindowStart;
+
+		// Stats that can be read from any thread, protected by StatsLock
+		TMap<uint32, FHoudiniLiveLinkStreamStats> StreamStats;
+		FHoudiniLiveLinkLatencyHistogram PublishedLatencyHistogram;
+		FHoudiniLiveLinkLatencyStats PublishedClockStats;
+		mutable FCriticalSection StatsLock;
+
+		// Lock-free capture buffer, written by this thread and read by the export task
+		TUniquePtr<TCircularQueue<FHoudiniLiveLinkCapturedFrame>> CaptureQueue;
+
+#if STATS
+		// Latency stats of the source, only published by the first receiver
+		TStatId LatencyP50StatId;
+		TStatId LatencyP95StatId;
+		TStatId LatencyP99StatId;
+		TStatId RoundTripTimeStatId;
+#endif
+
+		// Delay between two pings, and duration of a latency measurement window (in seconds)
+		static const double PingInterval;
+		static const double LatencyWindow;
+
+		// Senders whose frames stopped for this long (in seconds) aren't pinged anymore
+		static const double PingTimeout;
+
+		// Max delay between two pushes of the same frame while idle
+		static const double IdleRefreshDelay;
+
+		// Subjects are forgotten after this long without packets (in seconds). Subjects that never sent
+		// their name can't be pushed, they expire sooner. The source's own subject is always kept.
+		static const double SubjectTimeout;
+		static const double UnnamedSubjectTimeout;
+
+		// Max number of subjects per receiver, packets of new subjects are dropped beyond it
+		static const int32 MaxSubjects;
+
+		// Transform scale
+		// currently unused
+		static const double TransformScale;
+};
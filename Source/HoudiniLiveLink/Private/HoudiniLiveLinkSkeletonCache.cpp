@@ -0,0 +1,391 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "HoudiniLiveLinkSkeletonCache.h"
+#include "HoudiniLiveLinkProtocol.h"
+
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/LargeMemoryReader.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#define SKELETON_CACHE_MAGIC	0x534C4C48	// "HLLS"
+#define SKELETON_CACHE_VERSION	2
+
+void
+HoudiniLiveLinkWriteNames(FArchive& Writer, const TArray<FString>& Names)
+{
+	int32 NumNames = Names.Num();
+	Writer << NumNames;
+	for (const FString& Name : Names)
+	{
+		Writer << const_cast<FString&>(Name);
+	}
+}
+
+void
+HoudiniLiveLinkWriteNames(FArchive& Writer, const TArray<FName>& Names)
+{
+	TArray<FString> NameStrings;
+	NameStrings.Reserve(Names.Num());
+	for (const FName& Name : Names)
+	{
+		NameStrings.Add(Name.ToString());
+	}
+	HoudiniLiveLinkWriteNames(Writer, NameStrings);
+}
+
+bool
+HoudiniLiveLinkReadString(FArchive& Reader, FString& OutString)
+{
+	// FString's serializer allocates the length it reads: check it against the remaining bytes first
+	const int64 Start = Reader.Tell();
+	int32 SaveNum = 0;
+	Reader << SaveNum;
+
+	// Negative lengths are UCS-2 strings
+	const int64 NumBytes = SaveNum < 0 ? -(int64)SaveNum * (int64)sizeof(UCS2CHAR) : (int64)SaveNum;
+	if (Reader.IsError() || NumBytes > Reader.TotalSize() - Reader.Tell())
+	{
+		Reader.SetError();
+		return false;
+	}
+
+	Reader.Seek(Start);
+	Reader << OutString;
+	return !Reader.IsError();
+}
+
+bool
+HoudiniLiveLinkReadNames(FArchive& Reader, TArray<FString>& OutNames)
+{
+	// Each name takes at least its length
+	int32 NumNames = 0;
+	Reader << NumNames;
+	if (Reader.IsError() || NumNames < 0 || NumNames > (Reader.TotalSize() - Reader.Tell()) / (int64)sizeof(int32))
+	{
+		Reader.SetError();
+		return false;
+	}
+
+	OutNames.Reset(NumNames);
+	for (int32 NameIdx = 0; NameIdx < NumNames; ++NameIdx)
+	{
+		if (!HoudiniLiveLinkReadString(Reader, OutNames.AddDefaulted_GetRef()))
+			return false;
+	}
+
+	return true;
+}
+
+static uint32
+GetSubjectId(FName SubjectName)
+{
+	FTCHARToUTF8 Name(*SubjectName.ToString());
+	return HoudiniLiveLinkSubjectId(Name.Get(), Name.Length());
+}
+
+const int32
+FHoudiniLiveLinkSkeletonCache::MaxFilesPerSubject = 8;
+
+const double
+FHoudiniLiveLinkSkeletonCache::StaleTempFileAge = 3600.0;
+
+FHoudiniLiveLinkSkeletonCache::FHoudiniLiveLinkSkeletonCache(const FString& InDirectory)
+	: Directory(InDirectory)
+	, bLoaded(false)
+{
+}
+
+FHoudiniLiveLinkSkeletonCache::~FHoudiniLiveLinkSkeletonCache()
+{
+	if (PreloadResult.IsValid())
+		PreloadResult.Wait();
+
+	// Finish the writes still in progress, a session shouldn't leave temporary files behind
+	FScopeLock Lock(&WrittenFilesLock);
+	for (TFuture<void>& PendingWrite : PendingWrites)
+	{
+		PendingWrite.Wait();
+	}
+}
+
+void
+FHoudiniLiveLinkSkeletonCache::StartPreload()
+{
+	if (PreloadResult.IsValid())
+		return;
+
+	// Keep the file system off the game thread, frames wait for their static data until the cache is loaded
+	PreloadResult = Async(EAsyncExecution::ThreadPool, [this]()
+	{
+		DeleteStaleTempFiles(Directory);
+
+		for (const FString& Filename : PruneFiles(Directory, TEXT("*.hlls")))
+		{
+			LoadFile(Filename);
+		}
+
+		bLoaded = true;
+	});
+}
+
+void
+FHoudiniLiveLinkSkeletonCache::DeleteStaleTempFiles(const FString& InDirectory)
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	TArray<FString> Filenames;
+	FileManager.FindFiles(Filenames, *(InDirectory / TEXT("*.tmp")), true, false);
+
+	// Another editor instance may still be writing the recent ones
+	for (const FString& Filename : Filenames)
+	{
+		const FString Path = InDirectory / Filename;
+		if (FileManager.GetFileAgeSeconds(*Path) > StaleTempFileAge)
+			FileManager.Delete(*Path, false, false, true);
+	}
+}
+
+TArray<FString>
+FHoudiniLiveLinkSkeletonCache::PruneFiles(const FString& InDirectory, const FString& Wildcard)
+{
+	IFileManager& FileManager = IFileManager::Get();
+
+	TArray<FString> Filenames;
+	FileManager.FindFiles(Filenames, *(InDirectory / Wildcard), true, false);
+
+	// Files are named after their subject id (see GetFilename), newest first
+	TMap<FString, TArray<TPair<FDateTime, FString>>> SubjectFiles;
+	for (const FString& Filename : Filenames)
+	{
+		const FString Path = InDirectory / Filename;
+		SubjectFiles.FindOrAdd(Filename.Left(8)).Emplace(FileManager.GetTimeStamp(*Path), Path);
+	}
+
+	TArray<FString> KeptFiles;
+	for (TPair<FString, TArray<TPair<FDateTime, FString>>>& Pair : SubjectFiles)
+	{
+		TArray<TPair<FDateTime, FString>>& Files = Pair.Value;
+		Files.Sort([](const TPair<FDateTime, FString>& A, const TPair<FDateTime, FString>& B) { return A.Key > B.Key; });
+
+		for (int32 FileIdx = 0; FileIdx < Files.Num(); ++FileIdx)
+		{
+			if (FileIdx < MaxFilesPerSubject)
+				KeptFiles.Add(Files[FileIdx].Value);
+			else
+				FileManager.Delete(*Files[FileIdx].Value, false, false, true);
+		}
+	}
+
+	return KeptFiles;
+}
+
+bool
+FHoudiniLiveLinkSkeletonCache::LoadFile(const FString& Filename)
+{
+	FName SubjectName;
+	FHoudiniLiveLinkSkeleton Skeleton;
+
+	// The files are small and only read once: map them rather than copying them,
+	// unless the platform can't map files
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Filename));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile.IsValid() ? MappedFile->MapRegion() : nullptr);
+	if (MappedRegion.IsValid())
+	{
+		FLargeMemoryReader Reader(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+		if (!Load(Reader, SubjectName, Skeleton))
+			return false;
+	}
+	else
+	{
+		TArray<uint8> Data;
+		if (!FFileHelper::LoadFileToArray(Data, *Filename))
+			return false;
+
+		FMemoryReader Reader(Data);
+		if (!Load(Reader, SubjectName, Skeleton))
+			return false;
+	}
+
+	SubjectNames.Add(GetSubjectId(SubjectName), SubjectName);
+	Skeletons.FindOrAdd(SubjectName).Add(Skeleton.Hash, MoveTemp(Skeleton));
+	return true;
+}
+
+bool
+FHoudiniLiveLinkSkeletonCache::Load(FArchive& Reader, FName& OutSubjectName, FHoudiniLiveLinkSkeleton& OutSkeleton)
+{
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	uint64 Hash = 0;
+	Reader << Magic;
+	Reader << Version;
+	Reader << Hash;
+	if (Reader.IsError() || Magic != SKELETON_CACHE_MAGIC || Version != SKELETON_CACHE_VERSION)
+		return false;
+
+	// Files can be truncated (interrupted write) or corrupted: every count is checked against
+	// the remaining bytes before allocating, the hash is checked once everything is read
+	FString SubjectString;
+	if (!HoudiniLiveLinkReadString(Reader, SubjectString))
+		return false;
+
+	FLiveLinkSkeletonStaticData& StaticData = OutSkeleton.StaticData;
+	if (!HoudiniLiveLinkReadNames(Reader, OutSkeleton.BoneNameStrings))
+		return false;
+
+	// Same layout as a serialized TArray<int32>
+	int32 NumParents = 0;
+	Reader << NumParents;
+	if (Reader.IsError() || NumParents != OutSkeleton.BoneNameStrings.Num() || NumParents * (int64)sizeof(int32) > Reader.TotalSize() - Reader.Tell())
+		return false;
+
+	StaticData.BoneParents.SetNumUninitialized(NumParents);
+	Reader.Serialize(StaticData.BoneParents.GetData(), NumParents * sizeof(int32));
+
+	if (!HoudiniLiveLinkReadNames(Reader, OutSkeleton.CurveNameStrings))
+		return false;
+
+	if (Reader.IsError() || SubjectString.IsEmpty())
+		return false;
+
+	for (const FString& BoneName : OutSkeleton.BoneNameStrings)
+	{
+		StaticData.BoneNames.Add(FName(*BoneName));
+	}
+
+	for (const FString& CurveName : OutSkeleton.CurveNameStrings)
+	{
+		StaticData.PropertyNames.Add(FName(*CurveName));
+	}
+
+	for (int32 BoneIdx = 0; BoneIdx < StaticData.BoneParents.Num(); ++BoneIdx)
+	{
+		if (StaticData.BoneParents[BoneIdx] == -1)
+			OutSkeleton.Roots.Add(BoneIdx);
+	}
+
+	// Discard corrupted files
+	OutSkeleton.UpdateHash();
+	if (OutSkeleton.Hash != Hash)
+		return false;
+
+	OutSubjectName = FName(*SubjectString);
+	return true;
+}
+
+void
+FHoudiniLiveLinkSkeletonCache::Save(FArchive& Writer, FName SubjectName, const FHoudiniLiveLinkSkeleton& Skeleton)
+{
+	uint32 Magic = SKELETON_CACHE_MAGIC;
+	uint32 Version = SKELETON_CACHE_VERSION;
+	uint64 Hash = Skeleton.Hash;
+	FString SubjectString = SubjectName.ToString();
+	TArray<int32> BoneParents = Skeleton.StaticData.BoneParents;
+
+	Writer << Magic;
+	Writer << Version;
+	Writer << Hash;
+	Writer << SubjectString;
+	HoudiniLiveLinkWriteNames(Writer, Skeleton.BoneNameStrings);
+	Writer << BoneParents;
+	HoudiniLiveLinkWriteNames(Writer, Skeleton.CurveNameStrings);
+}
+
+const FHoudiniLiveLinkSkeleton*
+FHoudiniLiveLinkSkeletonCache::Find(FName SubjectName, uint64 Hash) const
+{
+	if (!bLoaded)
+		return nullptr;
+
+	const TMap<uint64, FHoudiniLiveLinkSkeleton>* SubjectSkeletons = Skeletons.Find(SubjectName);
+	return SubjectSkeletons ? SubjectSkeletons->Find(Hash) : nullptr;
+}
+
+FName
+FHoudiniLiveLinkSkeletonCache::FindSubjectName(uint32 SubjectId) const
+{
+	if (!bLoaded)
+		return NAME_None;
+
+	const FName* SubjectName = SubjectNames.Find(SubjectId);
+	return SubjectName ? *SubjectName : NAME_None;
+}
+
+FString
+FHoudiniLiveLinkSkeletonCache::GetFilename(FName SubjectName, uint64 Hash) const
+{
+	// Subject names can contain anything, use their id
+	return Directory / FString::Printf(TEXT("%08x_%016llx.hlls"), GetSubjectId(SubjectName), (unsigned long long)Hash);
+}
+
+void
+FHoudiniLiveLinkSkeletonCache::Add(FName SubjectName, const FHoudiniLiveLinkSkeleton& Skeleton)
+{
+	if (Find(SubjectName, Skeleton.Hash))
+		return;
+
+	// Houdini resends the static data periodically
+	const FString Filename = GetFilename(SubjectName, Skeleton.Hash);
+	{
+		FScopeLock Lock(&WrittenFilesLock);
+		if (WrittenFiles.Contains(Filename))
+			return;
+
+		WrittenFiles.Add(Filename);
+	}
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	Save(Writer, SubjectName, Skeleton);
+
+	FScopeLock Lock(&WrittenFilesLock);
+	PendingWrites.RemoveAll([](const TFuture<void>& PendingWrite) { return PendingWrite.IsReady(); });
+
+	// Keep the file system off the receive threads. Every rig edit adds a file, only keep the subject's latest ones.
+	const FString SubjectWildcard = FPaths::GetCleanFilename(Filename).Left(8) + TEXT("_*.hlls");
+	PendingWrites.Add(Async(EAsyncExecution::ThreadPool, [Data = MoveTemp(Data), Filename, CacheDirectory = Directory, SubjectWildcard]()
+	{
+		// Written to a temporary file then moved in place, so a crash or another editor instance
+		// never sees a partial file
+		const FString TempFilename = FPaths::CreateTempFilename(*CacheDirectory, TEXT("Skeleton"), TEXT(".tmp"));
+		if (!FFileHelper::SaveArrayToFile(Data, *TempFilename))
+			return;
+
+		if (IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+			PruneFiles(CacheDirectory, SubjectWildcard);
+		else
+			IFileManager::Get().Delete(*TempFilename, false, false, true);
+	}));
+}
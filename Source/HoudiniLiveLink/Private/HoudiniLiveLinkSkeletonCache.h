@@ -0,0 +1,104 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "HoudiniLiveLinkReceiver.h"
+
+class FArchive;
+
+// Arrays of names are written as strings, plain archives can't serialize FNames.
+// Same layout as a serialized TArray<FString>. When reading, the counts and lengths are checked against
+// the remaining bytes before allocating: false (and an archive error) if the data is truncated.
+void HoudiniLiveLinkWriteNames(FArchive& Writer, const TArray<FString>& Names);
+void HoudiniLiveLinkWriteNames(FArchive& Writer, const TArray<FName>& Names);
+bool HoudiniLiveLinkReadNames(FArchive& Reader, TArray<FString>& OutNames);
+bool HoudiniLiveLinkReadString(FArchive& Reader, FString& OutString);
+
+// Skeletons received from Houdini, saved to disk so the frames of a subject can be pushed as soon as
+// they arrive after a restart, instead of waiting for the next static data packet.
+// One small file per subject/skeleton hash, read through a memory mapping when the source starts.
+// Only the most recent files of each subject are kept.
+class FHoudiniLiveLinkSkeletonCache
+{
+	public:
+
+		explicit FHoudiniLiveLinkSkeletonCache(const FString& InDirectory);
+
+		~FHoudiniLiveLinkSkeletonCache();
+
+		// Loads the cached skeletons in the background, they can be found once loaded
+		void StartPreload();
+
+		// Returns the cached skeleton of a subject with the given hash, null if there is none (or it isn't loaded yet)
+		const FHoudiniLiveLinkSkeleton* Find(FName SubjectName, uint64 Hash) const;
+
+		// Returns the name of the cached subject with the given header id, None if there is none (or it isn't loaded yet)
+		FName FindSubjectName(uint32 SubjectId) const;
+
+		// Writes a skeleton to the cache in the background, if it isn't in it already
+		void Add(FName SubjectName, const FHoudiniLiveLinkSkeleton& Skeleton);
+
+		bool IsLoaded() const { return bLoaded; }
+
+		// Contents of a cache file. Load returns false if the data is truncated or corrupted.
+		static void Save(FArchive& Writer, FName SubjectName, const FHoudiniLiveLinkSkeleton& Skeleton);
+		static bool Load(FArchive& Reader, FName& OutSubjectName, FHoudiniLiveLinkSkeleton& OutSkeleton);
+
+	private:
+
+		FString GetFilename(FName SubjectName, uint64 Hash) const;
+
+		// Deletes all but the MaxFilesPerSubject most recent files of each subject among the files matching
+		// the wildcard, returns the paths of the files kept
+		static TArray<FString> PruneFiles(const FString& InDirectory, const FString& Wildcard);
+
+		// Deletes the temporary files left by interrupted writes
+		static void DeleteStaleTempFiles(const FString& InDirectory);
+
+		// Reads a cache file, returns false if it is invalid
+		bool LoadFile(const FString& Filename);
+
+		FString Directory;
+
+		// Preloaded skeletons, written by the preload task then read only once bLoaded is set
+		TMap<FName, TMap<uint64, FHoudiniLiveLinkSkeleton>> Skeletons;
+		TMap<uint32, FName> SubjectNames;
+		FThreadSafeBool bLoaded;
+		TFuture<void> PreloadResult;
+
+		// Number of skeletons kept per subject, older ones are deleted
+		static const int32 MaxFilesPerSubject;
+
+		// Age (in seconds) after which a temporary file is considered left by an interrupted write
+		static const double StaleTempFileAge;
+
+		// Files written by this session, and the writes still in progress
+		TSet<FString> WrittenFiles;
+		TArray<TFuture<void>> PendingWrites;
+		FCriticalSection WrittenFilesLock;
+};
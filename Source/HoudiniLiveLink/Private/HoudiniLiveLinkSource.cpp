@@ -1,384 +1,637 @@
-/*
-* Copyright (c) <2020> Side Effects Software Inc.
-* All rights reserved.
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions are met:
-*
-* 1. Redistributions of source code must retain the above copyright notice,
-*    this list of conditions and the following disclaimer.
-*
-* 2. The name of Side Effects Software may not be used to endorse or
-*    promote products derived from this software without specific prior
-*    written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
-* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
-* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
-* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
-* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
-* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*/
-
-#include "HoudiniLiveLinkSource.h"
-
-#include "ILiveLinkClient.h"
-#include "LiveLinkTypes.h"
-#include "Roles/LiveLinkAnimationRole.h"
-#include "Roles/LiveLinkAnimationTypes.h"
-#include "Common/UdpSocketBuilder.h"
-#include "Sockets.h"
-
-#include "Async/Async.h"
-#include "HAL/RunnableThread.h"
-
-#define LOCTEXT_NAMESPACE "HoudiniLiveLinkSource"
-
-#define RECV_BUFFER_SIZE 1024 * 1024
-
-const double
-FHoudiniLiveLinkSource::TransformScale = 1.0;
-
-FHoudiniLiveLinkSource::FHoudiniLiveLinkSource(FIPv4Endpoint InEndpoint, const float& InRefreshRate, const FString& InSubjectName)
-	: Stopping(false)
-	, Thread(nullptr)
-	, SkeletonSetupNeeded(true)
-{
-	// defaults
-	DeviceEndpoint = InEndpoint;
-
-	UpdateFrequency = 0.1f;
-	if (InRefreshRate > 0.0f)
-	{
-		UpdateFrequency = 1 / InRefreshRate;
-	}
-
-	SourceStatus = LOCTEXT("SourceStatus_DeviceNotFound", "Device Not Found");
-	SourceType = LOCTEXT("HoudiniLiveLinkSourceType", "Houdini LiveLink");
-	SourceMachineName = LOCTEXT("HoudiniLiveLinkSourceMachineName", "localhost");
-
-	// Default subject name
-	SubjectName = TEXT("Houdini Subject");
-	if (!InSubjectName.IsEmpty())
-		SubjectName = FName(*InSubjectName);
-
-	{
-		Start();
-		SourceStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
-	}
-}
-
-FHoudiniLiveLinkSource::~FHoudiniLiveLinkSource()
-{
-	Stop();
-	if (Thread != nullptr)
-	{
-		Thread->WaitForCompletion();
-		delete Thread;
-		Thread = nullptr;
-	}
-}
-
-void 
-FHoudiniLiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
-{
-	Client = InClient;
-	SourceGuid = InSourceGuid;
-}
-
-bool 
-FHoudiniLiveLinkSource::IsSourceStillValid() const
-{
-	// Source is valid if we have a valid thread and socket
-	bool bIsSourceValid = !Stopping && Thread != nullptr;
-	return bIsSourceValid;
-}
-
-bool 
-FHoudiniLiveLinkSource::RequestSourceShutdown()
-{
-	Stop();
-	SourceStatus = LOCTEXT("SourceStatus_Stopped", "Stopped");
-
-	return true;
-}
-
-// FRunnable interface
-void 
-FHoudiniLiveLinkSource::Start()
-{
-	SkeletonSetupNeeded = true;
-	NumBones = -1;
-	NumCurves = -1;
-
-	ThreadName = "Houdini Live Link ";
-	ThreadName.AppendInt(FAsyncThreadIndex::GetNext());
-	
-	Thread = FRunnableThread::Create(this, *ThreadName, 128 * 1024, TPri_AboveNormal, FPlatformAffinity::GetPoolThreadMask());
-}
-
-void
-FHoudiniLiveLinkSource::Stop()
-{
-	Stopping = true;
-	SkeletonSetupNeeded = true;
-}
-
-const int BUFFER_SIZE = 65536;
-uint32
-FHoudiniLiveLinkSource::Run()
-{
-	FUdpSocketBuilder builder("Houdini Live Link Receiver");
-	builder.AsBlocking();
-	builder.AsReusable();
-	builder.BoundToAddress(FIPv4Address::Any);
-	builder.BoundToPort(DeviceEndpoint.Port);
-	builder.WithReceiveBufferSize(BUFFER_SIZE);
-
-	char buf[BUFFER_SIZE];
-	
-	FSocket* socket = builder.Build();
-	if (socket)
-	{
-		if (socket->GetConnectionState() != ESocketConnectionState::SCS_Connected)
-			return 0;
-		
-		while (!Stopping)
-		{
-			int32 num_read;
-			if (socket->Wait(ESocketWaitConditions::WaitForRead, 100))
-			{
-				socket->Recv((uint8*)buf, BUFFER_SIZE, num_read, ESocketReceiveFlags::None);
-				
-				SkeletonSetupNeeded = !ProcessResponseData(FString(num_read, buf));
-			}
-		}
-		socket->Close();
-	}
-	return 0;
-}
-
-bool 
-FHoudiniLiveLinkSource::ProcessResponseData(const FString& ReceivedData)
-{
-	// No need to process the data if we're stopping
-	if(Stopping || !Thread)
-		return false;
-
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ReceivedData);
-	if (!FJsonSerializer::Deserialize(Reader, JsonObject))
-	{
-		// Whatever we received is not JSON
-		return false;
-	}
-
-	// Setup is done via GetSkeleton, and returns the following values:
-	// parents (Int Array), vertices (FVector Array), Names (String Array)
-
-	// Update is done via GetSkeletonPose, and has:
-	// position (FVector Array), rotations (FVector Array), Names (String Array)
-
-	// Static Data 
-	bool bStaticDataUpdated = false;
-	FLiveLinkStaticDataStruct StaticDataStruct = FLiveLinkStaticDataStruct(FLiveLinkSkeletonStaticData::StaticStruct());
-	FLiveLinkSkeletonStaticData& StaticData = *StaticDataStruct.Cast<FLiveLinkSkeletonStaticData>();
-
-	// Frame Data
-	bool bFrameDataUpdated = false;
-	FLiveLinkFrameDataStruct FrameDataStruct = FLiveLinkFrameDataStruct(FLiveLinkAnimationFrameData::StaticStruct());
-	FLiveLinkAnimationFrameData& FrameData = *FrameDataStruct.Cast<FLiveLinkAnimationFrameData>();
-
-	for (TPair<FString, TSharedPtr<FJsonValue>>& JsonField : JsonObject->Values)
-	{
-		const TArray<TSharedPtr<FJsonValue>>& ValueArray = JsonField.Value->AsArray();
-		if (JsonField.Key.Equals(TEXT("parents"), ESearchCase::IgnoreCase))
-		{
-			// Parents (STATIC DATA) (GetSkeleton)
-			Roots.Empty();
-			StaticData.BoneParents.SetNumUninitialized(ValueArray.Num());
-			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); BoneIdx++)
-			{
-				if (ValueArray[BoneIdx]->IsNull())
-				{
-					// Root Node
-					StaticData.BoneParents[BoneIdx] = -1;
-					Roots.Add(BoneIdx);
-				}
-				else
-				{
-					StaticData.BoneParents[BoneIdx] = (int32)ValueArray[BoneIdx]->AsNumber();
-				}
-			}
-
-			bStaticDataUpdated = true;
-		}
-		else if (JsonField.Key.Equals(TEXT("names"), ESearchCase::IgnoreCase))
-		{
-			// Names (STATIC DATA) (both)
-			StaticData.BoneNames.SetNumUninitialized(ValueArray.Num());
-
-			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); BoneIdx++)
-			{
-				FString BoneName = ValueArray[BoneIdx]->AsString();
-				StaticData.BoneNames[BoneIdx] = FName(*BoneName);
-			}
-
-			bStaticDataUpdated = true;
-		}
-		else if (JsonField.Key.Equals(TEXT("positions"), ESearchCase::IgnoreCase))
-		{
-			// Check the validity of the data we received
-			if (!SkeletonSetupNeeded && ValueArray.Num() != NumBones)
-				return false;
-
-			// positions (FRAME DATA) (GetSkeletonPose)
-			if(FrameData.Transforms.Num() <= 0)
-				FrameData.Transforms.Init(FTransform::Identity, ValueArray.Num()); 
-
-			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); ++BoneIdx)
-			{
-				const TArray<TSharedPtr<FJsonValue>>& LocationArray = ValueArray[BoneIdx]->AsArray();
-
-				FVector BoneLocation = FVector::ZeroVector;
-				if ( LocationArray.Num() == 3) // X, Y, Z
-				{
-					double X = LocationArray[0]->AsNumber();
-					double Y = LocationArray[1]->AsNumber();
-					double Z = LocationArray[2]->AsNumber();
-
-					// Houdini to Unreal: Swap Y/Z, meters to cm
-					BoneLocation = FVector(X, -Y, Z) * TransformScale;
-				}
-				FrameData.Transforms[BoneIdx].SetLocation(BoneLocation);
-			}
-
-			bFrameDataUpdated = true;
-		}
-		else if (JsonField.Key.Equals(TEXT("rotations"), ESearchCase::IgnoreCase))
-		{
-			// Check the validity of the data we received
-			if (!SkeletonSetupNeeded && ValueArray.Num() != NumBones)
-			 	return false;
-
-			// rotations (FRAME DATA) (GetSkeletonPose)
-			if (FrameData.Transforms.Num() <= 0)
-				FrameData.Transforms.Init(FTransform::Identity, ValueArray.Num());
-
-			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); ++BoneIdx)
-			{
-				const TArray<TSharedPtr<FJsonValue>>& RotationArray = ValueArray[BoneIdx]->AsArray();
-
-				FQuat HQuat = FQuat::Identity;
-				if (RotationArray.Num() == 3)
-				{
-					double X = RotationArray[0]->AsNumber();
-					double Y = RotationArray[1]->AsNumber();
-					double Z = RotationArray[2]->AsNumber();
-
-					HQuat = FQuat::MakeFromEuler(FVector(X, -Y, -Z));
-				}
-				else if (RotationArray.Num() == 4)
-				{
-					// TODO: untested, the livelink HDA doesnot send quaternions for now
-					double X = RotationArray[0]->AsNumber();
-					double Y = RotationArray[1]->AsNumber();
-					double Z = RotationArray[2]->AsNumber();
-					double W = RotationArray[3]->AsNumber();
-					HQuat = FQuat(X, Z, Y, -W);
-				}
-
-				FrameData.Transforms[BoneIdx].SetRotation(HQuat);
-				if (Roots.Contains(BoneIdx))
-				{
-					FTransform rotate(FQuat::MakeFromEuler(FVector(90.0f, 0, 0)));
-					FrameData.Transforms[BoneIdx] = FrameData.Transforms[BoneIdx] * rotate;
-				}
-			}
-
-			bFrameDataUpdated = true;
-		}
-		else if (JsonField.Key.Equals(TEXT("scales"), ESearchCase::IgnoreCase))
-		{
-			// Check the validity of the data we received
-			if (!SkeletonSetupNeeded && ValueArray.Num() != NumBones)
-				return false;
-
-			// scale (FRAME DATA) (GetSkeletonPose)
-			if (FrameData.Transforms.Num() <= 0)
-				FrameData.Transforms.Init(FTransform::Identity, ValueArray.Num());
-		
-			for (int BoneIdx = 0; BoneIdx < ValueArray.Num(); ++BoneIdx)
-			{
-				const TArray<TSharedPtr<FJsonValue>>& ScaleArray = ValueArray[BoneIdx]->AsArray();
-
-				FVector BoneScale = FVector::OneVector;
-				if (ScaleArray.Num() == 3) // X, Y, Z
-				{
-					double X = ScaleArray[0]->AsNumber();
-					double Y = ScaleArray[1]->AsNumber();
-					double Z = ScaleArray[2]->AsNumber();
-
-					// Houdini to Unreal: Swap Y/Z
-					BoneScale = FVector(X, Z, Y);
-				}
-
-				FrameData.Transforms[BoneIdx].SetScale3D(BoneScale);
-			}
-
-			bFrameDataUpdated = true;
-		}
-		else if (JsonField.Key.Equals(TEXT("blendshape_names"), ESearchCase::IgnoreCase))
-		{
-			StaticData.PropertyNames.Empty(ValueArray.Num());
-
-			for (int i = 0; i < ValueArray.Num(); ++i)
-			{
-				StaticData.PropertyNames.Add(FName(ValueArray[i]->AsString()));
-			}
-
-			bStaticDataUpdated = true;
-		}
-		else if (JsonField.Key.Equals(TEXT("blendshape_values"), ESearchCase::IgnoreCase))
-		{
-			// Check the validity of the data we received
-			if (!SkeletonSetupNeeded && ValueArray.Num() != NumCurves)
-				return false;
-
-			FrameData.PropertyValues.Empty(ValueArray.Num());
-
-			for (int i = 0; i < ValueArray.Num(); ++i)
-			{
-				FrameData.PropertyValues.Add(ValueArray[i]->AsNumber());
-			}
-
-			bFrameDataUpdated = true;
-		}
-	}
-
-	// Make sure the source is still valid before attempting to update the client data
-	if (!IsSourceStillValid())
-		return false;
-
-	if (bStaticDataUpdated && SkeletonSetupNeeded)
-	{
-		// Only update the static data if the skeleton setup is required!
-		NumBones = StaticData.BoneNames.Num();
-		NumCurves = StaticData.PropertyNames.Num();
-		Client->PushSubjectStaticData_AnyThread({ SourceGuid, SubjectName }, ULiveLinkAnimationRole::StaticClass(), MoveTemp(StaticDataStruct));
-	}
-
-	if (bFrameDataUpdated  && !SkeletonSetupNeeded)
-	{
-		// Only update the frame data if where not setting up the skeleton
-		Client->PushSubjectFrameData_AnyThread({ SourceGuid, SubjectName }, MoveTemp(FrameDataStruct));
-	}
-
-	return true;
-}
-
-#undef LOCTEXT_NAMESPACE
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "HoudiniLiveLinkSource.h"
+#include "HoudiniLiveLinkReceiver.h"
+#include "HoudiniLiveLinkSkeletonCache.h"
+
+#include "ILiveLinkClient.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/Archive.h"
+
+#include "Animation/Skeleton.h"
+#include "Async/Async.h"
+
+#define LOCTEXT_NAMESPACE "HoudiniLiveLinkSource"
+
+// Every source that exists, for the console commands and the lookups by subject
+static TArray<FHoudiniLiveLinkSource*> GHoudiniLiveLinkSources;
+static FCriticalSection GHoudiniLiveLinkSourcesLock;
+
+FString
+FHoudiniLiveLinkSourceOptions::ToString() const
+{
+	// Sources using the default options keep the plain endpoint as their connection string
+	TArray<FString> Values;
+	if (UsesMulticast())
+	{
+		Values.Add(FString::Printf(TEXT("MulticastGroup=%s MulticastInterface=%s MulticastTTL=%d"),
+			*MulticastGroup.ToString(), *MulticastInterface.ToString(), (int32)MulticastTtl));
+	}
+
+	if (CaptureBufferSize > 0)
+		Values.Add(FString::Printf(TEXT("CaptureBufferSize=%d"), CaptureBufferSize));
+
+	if (!TargetSkeleton.IsEmpty())
+		Values.Add(FString::Printf(TEXT("TargetSkeleton=\"%s\""), *TargetSkeleton));
+
+	if (BoneNameMap.Num() > 0)
+		Values.Add(FString::Printf(TEXT("BoneMap=\"%s\""), *BoneNameMapToString(BoneNameMap)));
+
+	if (NumReceiveThreads > 1)
+		Values.Add(FString::Printf(TEXT("ReceiveThreads=%d"), NumReceiveThreads));
+
+	if (bComputeComponentSpace)
+		Values.Add(TEXT("ComponentSpace=true"));
+
+	return FString::Join(Values, TEXT(" "));
+}
+
+void
+FHoudiniLiveLinkSourceOptions::Parse(const FString& InString, FHoudiniLiveLinkSourceOptions& OutOptions)
+{
+	FString Address;
+	if (FParse::Value(*InString, TEXT("MulticastGroup="), Address))
+		FIPv4Address::Parse(Address, OutOptions.MulticastGroup);
+
+	if (FParse::Value(*InString, TEXT("MulticastInterface="), Address))
+		FIPv4Address::Parse(Address, OutOptions.MulticastInterface);
+
+	int32 Ttl = OutOptions.MulticastTtl;
+	if (FParse::Value(*InString, TEXT("MulticastTTL="), Ttl))
+		OutOptions.MulticastTtl = (uint8)FMath::Clamp(Ttl, 0, 255);
+
+	FParse::Value(*InString, TEXT("TargetSkeleton="), OutOptions.TargetSkeleton);
+
+	FString BoneMap;
+	if (FParse::Value(*InString, TEXT("BoneMap="), BoneMap))
+		ParseBoneNameMap(BoneMap, OutOptions.BoneNameMap);
+
+	int32 CaptureSize = OutOptions.CaptureBufferSize;
+	if (FParse::Value(*InString, TEXT("CaptureBufferSize="), CaptureSize))
+		OutOptions.CaptureBufferSize = FMath::Max(CaptureSize, 0);
+
+	int32 ReceiveThreads = OutOptions.NumReceiveThreads;
+	if (FParse::Value(*InString, TEXT("ReceiveThreads="), ReceiveThreads))
+		OutOptions.NumReceiveThreads = FMath::Max(ReceiveThreads, 1);
+
+	FParse::Bool(*InString, TEXT("ComponentSpace="), OutOptions.bComputeComponentSpace);
+}
+
+FString
+FHoudiniLiveLinkSourceOptions::BoneNameMapToString(const TMap<FName, FName>& InMap)
+{
+	TArray<FString> Pairs;
+	for (const TPair<FName, FName>& Pair : InMap)
+	{
+		Pairs.Add(FString::Printf(TEXT("%s:%s"), *Pair.Key.ToString(), *Pair.Value.ToString()));
+	}
+
+	return FString::Join(Pairs, TEXT(","));
+}
+
+void
+FHoudiniLiveLinkSourceOptions::ParseBoneNameMap(const FString& InString, TMap<FName, FName>& OutMap)
+{
+	OutMap.Reset();
+
+	TArray<FString> Pairs;
+	InString.ParseIntoArray(Pairs, TEXT(","));
+	for (const FString& Pair : Pairs)
+	{
+		FString HoudiniName, TargetName;
+		if (!Pair.Split(TEXT(":"), &HoudiniName, &TargetName))
+			continue;
+
+		HoudiniName.TrimStartAndEndInline();
+		TargetName.TrimStartAndEndInline();
+		if (HoudiniName.IsEmpty() || TargetName.IsEmpty())
+			continue;
+
+		OutMap.Add(FName(*HoudiniName), FName(*TargetName));
+	}
+}
+
+FHoudiniLiveLinkSource::FHoudiniLiveLinkSource(FIPv4Endpoint InEndpoint, const float& InRefreshRate, const FString& InSubjectName, const FHoudiniLiveLinkSourceOptions& InOptions)
+	: Client(nullptr)
+	, Options(InOptions)
+	, Stopping(false)
+{
+	// defaults
+	DeviceEndpoint = InEndpoint;
+
+	UpdateFrequency = 0.1f;
+	if (InRefreshRate > 0.0f)
+	{
+		UpdateFrequency = 1 / InRefreshRate;
+	}
+
+	SourceStatus = LOCTEXT("SourceStatus_DeviceNotFound", "Device Not Found");
+	SourceType = LOCTEXT("HoudiniLiveLinkSourceType", "Houdini LiveLink");
+	SourceMachineName = LOCTEXT("HoudiniLiveLinkSourceMachineName", "localhost");
+	if (Options.UsesMulticast())
+		SourceMachineName = FText::FromString(Options.MulticastGroup.ToString());
+
+	// Default subject name
+	SubjectName = TEXT("Houdini Subject");
+	if (!InSubjectName.IsEmpty())
+		SubjectName = FName(*InSubjectName);
+
+	// Resolve the target skeleton once, frames are remapped to it on the socket thread
+	bHasTargetLayout = false;
+	if (!Options.TargetSkeleton.IsEmpty())
+	{
+		if (USkeleton* Skeleton = LoadObject<USkeleton>(nullptr, *Options.TargetSkeleton))
+		{
+			const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
+			for (int32 BoneIdx = 0; BoneIdx < RefSkeleton.GetNum(); ++BoneIdx)
+			{
+				TargetLayout.BoneNames.Add(RefSkeleton.GetBoneName(BoneIdx));
+				TargetLayout.BoneParents.Add(RefSkeleton.GetParentIndex(BoneIdx));
+			}
+			TargetLayout.RefPose = RefSkeleton.GetRefBonePose();
+			bHasTargetLayout = true;
+		}
+	}
+
+	// Several sockets bound to the same port only share the load with SO_REUSEPORT, which Windows doesn't have.
+	// Multicast packets are delivered to every socket of the group: a single receiver must get them.
+#if PLATFORM_WINDOWS
+	Options.NumReceiveThreads = 1;
+#endif
+	if (Options.UsesMulticast())
+		Options.NumReceiveThreads = 1;
+
+	Options.NumReceiveThreads = FMath::Clamp(Options.NumReceiveThreads, 1, FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+
+	FString SkeletonCacheDirectory = Options.SkeletonCacheDirectory;
+	if (SkeletonCacheDirectory.IsEmpty())
+		SkeletonCacheDirectory = FPaths::ProjectSavedDir() / TEXT("HoudiniLiveLink") / TEXT("Skeletons");
+
+	SkeletonCache = MakeUnique<FHoudiniLiveLinkSkeletonCache>(SkeletonCacheDirectory);
+
+	FScopeLock Lock(&GHoudiniLiveLinkSourcesLock);
+	GHoudiniLiveLinkSources.Add(this);
+}
+
+FHoudiniLiveLinkSource::~FHoudiniLiveLinkSource()
+{
+	{
+		FScopeLock Lock(&GHoudiniLiveLinkSourcesLock);
+		GHoudiniLiveLinkSources.Remove(this);
+	}
+
+	Stop();
+
+	// The capture task reads the receivers' capture queues
+	StopCapture();
+	if (CaptureExportResult.IsValid())
+		CaptureExportResult.Wait();
+
+	// Waits for the receive threads
+	Receivers.Reset();
+}
+
+void 
+FHoudiniLiveLinkSource::ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid)
+{
+	Client = InClient;
+	SourceGuid = InSourceGuid;
+
+	// Start receiving once the frames can be pushed
+	Start();
+}
+
+bool 
+FHoudiniLiveLinkSource::IsSourceStillValid() const
+{
+	// Source is valid if we have a valid thread and socket
+	bool bIsSourceValid = !Stopping && Receivers.Num() > 0 && Receivers[0]->IsRunning();
+	return bIsSourceValid;
+}
+
+bool 
+FHoudiniLiveLinkSource::RequestSourceShutdown()
+{
+	Stop();
+	SourceStatus = LOCTEXT("SourceStatus_Stopped", "Stopped");
+
+	return true;
+}
+
+void
+FHoudiniLiveLinkSource::Start()
+{
+	if (Receivers.Num() > 0)
+		return;
+
+	// Skeletons from the previous sessions, so the first frames don't wait for the static data
+	SkeletonCache->StartPreload();
+	SourceStatus = LOCTEXT("SourceStatus_Receiving", "Receiving");
+
+	for (int32 ReceiverIdx = 0; ReceiverIdx < Options.NumReceiveThreads; ++ReceiverIdx)
+	{
+		Receivers.Add(MakeUnique<FHoudiniLiveLinkReceiver>(*this, ReceiverIdx));
+	}
+
+	// The receivers read each other's stats, only start them once they all exist
+	for (const TUniquePtr<FHoudiniLiveLinkReceiver>& Receiver : Receivers)
+	{
+		Receiver->Start();
+	}
+}
+
+void
+FHoudiniLiveLinkSource::Stop()
+{
+	Stopping = true;
+}
+
+FHoudiniLiveLinkLatencyStats
+FHoudiniLiveLinkSource::GetLatencyStats() const
+{
+	FHoudiniLiveLinkLatencyHistogram Histogram;
+	FHoudiniLiveLinkLatencyStats Stats;
+	for (const TUniquePtr<FHoudiniLiveLinkReceiver>& Receiver : Receivers)
+	{
+		Receiver->GetLatencyStats(Histogram, Stats);
+	}
+
+	Stats.NumSamples = Histogram.GetNumSamples();
+	if (Stats.NumSamples > 0)
+	{
+		Stats.P50 = Histogram.GetPercentile(0.50);
+		Stats.P95 = Histogram.GetPercentile(0.95);
+		Stats.P99 = Histogram.GetPercentile(0.99);
+	}
+
+	return Stats;
+}
+
+FText
+FHoudiniLiveLinkSource::GetSourceStatus() const
+{
+	if (Stopping)
+		return SourceStatus;
+
+	const FHoudiniLiveLinkLatencyStats Latency = GetLatencyStats();
+	if (Latency.NumSamples <= 0)
+		return SourceStatus;
+
+	const FHoudiniLiveLinkStreamStats Stream = GetStreamStats();
+
+	FNumberFormattingOptions Format;
+	Format.MinimumFractionalDigits = 1;
+	Format.MaximumFractionalDigits = 1;
+
+	return FText::Format(LOCTEXT("SourceStatus_Latency", "{0} - Latency p50 {1}ms p95 {2}ms p99 {3}ms, {4} lost"),
+		SourceStatus,
+		FText::AsNumber(Latency.P50, &Format),
+		FText::AsNumber(Latency.P95, &Format),
+		FText::AsNumber(Latency.P99, &Format),
+		FText::AsNumber(Stream.Lost));
+}
+
+FHoudiniLiveLinkStreamStats
+FHoudiniLiveLinkSource::GetStreamStats() const
+{
+	FHoudiniLiveLinkStreamStats Stats;
+	for (const TUniquePtr<FHoudiniLiveLinkReceiver>& Receiver : Receivers)
+	{
+		Receiver->GetStreamStats(Stats);
+	}
+	return Stats;
+}
+
+bool
+FHoudiniLiveLinkSource::StartCapture(const FString& Filename)
+{
+	if (Options.CaptureBufferSize <= 0 || Stopping)
+		return false;
+
+	// The queues only support a single reader
+	if (bExportingCapture.AtomicSet(true))
+		return false;
+
+	// Frames left over from the end of the last take
+	FHoudiniLiveLinkCapturedFrame Frame;
+	for (const TUniquePtr<FHoudiniLiveLinkReceiver>& Receiver : Receivers)
+	{
+		if (TCircularQueue<FHoudiniLiveLinkCapturedFrame>* Queue = Receiver->GetCaptureQueue())
+		{
+			while (Queue->Dequeue(Frame));
+		}
+	}
+
+	CaptureDroppedFrames.Reset();
+	bCapturing = true;
+
+	CaptureExportResult = Async(EAsyncExecution::ThreadPool, [this, Filename]()
+	{
+		const bool bSuccess = WriteCapture(Filename);
+		bExportingCapture = false;
+		return bSuccess;
+	});
+
+	return true;
+}
+
+void
+FHoudiniLiveLinkSource::StopCapture()
+{
+	bCapturing = false;
+}
+
+bool
+FHoudiniLiveLinkSource::WriteCapture(const FString& Filename)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer.IsValid())
+	{
+		bCapturing = false;
+		return false;
+	}
+
+	// Header
+	uint32 Magic = 0x434C4C48; // "HLLC"
+	uint32 Version = 3;
+	*Writer << Magic;
+	*Writer << Version;
+
+	// The buffers only absorb the bursts, they are drained continuously for the whole take.
+	// Frames of all the receive threads are merged by receive time.
+	// Each frame is preceded by the skeleton of its subject when it changes. The last skeletons are kept
+	// alive so a new skeleton can't be mistaken for one that was freed.
+	TMap<FName, TSharedPtr<const FLiveLinkSkeletonStaticData, ESPMode::ThreadSafe>> LastSkeletons;
+	FHoudiniLiveLinkCapturedFrame Frame;
+	while (true)
+	{
+		// Frames received before the take stopped are written by the last pass
+		const bool bLastPass = !bCapturing;
+
+		int32 NumWritten = 0;
+		while (true)
+		{
+			TCircularQueue<FHoudiniLiveLinkCapturedFrame>* NextQueue = nullptr;
+			for (const TUniquePtr<FHoudiniLiveLinkReceiver>& Receiver : Receivers)
+			{
+				TCircularQueue<FHoudiniLiveLinkCapturedFrame>* Queue = Receiver->GetCaptureQueue();
+				const FHoudiniLiveLinkCapturedFrame* Head = Queue ? Queue->Peek() : nullptr;
+				if (Head && (!NextQueue || Head->Time < NextQueue->Peek()->Time))
+					NextQueue = Queue;
+			}
+
+			if (!NextQueue || !NextQueue->Dequeue(Frame))
+				break;
+
+			FString SubjectString = Frame.SubjectName.ToString();
+			*Writer << SubjectString;
+
+			TSharedPtr<const FLiveLinkSkeletonStaticData, ESPMode::ThreadSafe>& LastSkeleton = LastSkeletons.FindOrAdd(Frame.SubjectName);
+			uint8 bHasSkeleton = Frame.Skeleton != LastSkeleton && Frame.Skeleton.IsValid();
+			*Writer << bHasSkeleton;
+			if (bHasSkeleton)
+			{
+				TArray<int32> BoneParents = Frame.Skeleton->BoneParents;
+				HoudiniLiveLinkWriteNames(*Writer, Frame.Skeleton->BoneNames);
+				*Writer << BoneParents;
+				HoudiniLiveLinkWriteNames(*Writer, Frame.Skeleton->PropertyNames);
+				LastSkeleton = Frame.Skeleton;
+			}
+
+			*Writer << Frame.Time;
+			*Writer << Frame.SendTime;
+			*Writer << Frame.Transforms;
+			*Writer << Frame.PropertyValues;
+			NumWritten++;
+		}
+
+		if (bLastPass)
+			break;
+
+		if (NumWritten == 0)
+			FPlatformProcess::Sleep(0.005f);
+	}
+
+	return Writer->Close();
+}
+
+void
+FHoudiniLiveLinkSource::ForEachSource(TFunctionRef<void(FHoudiniLiveLinkSource&)> Function)
+{
+	FScopeLock Lock(&GHoudiniLiveLinkSourcesLock);
+	for (FHoudiniLiveLinkSource* Source : GHoudiniLiveLinkSources)
+	{
+		Function(*Source);
+	}
+}
+
+bool
+FHoudiniLiveLinkSource::GetComponentSpacePose(FName InSubjectName, FHoudiniLiveLinkComponentSpacePose& OutPose) const
+{
+	FScopeLock Lock(&ComponentSpacePosesLock);
+	const FHoudiniLiveLinkComponentSpacePose* Pose = ComponentSpacePoses.Find(InSubjectName);
+	if (!Pose)
+		return false;
+
+	OutPose = *Pose;
+	return true;
+}
+
+bool
+FHoudiniLiveLinkSource::FindComponentSpacePose(FName InSubjectName, FHoudiniLiveLinkComponentSpacePose& OutPose)
+{
+	bool bFound = false;
+	FHoudiniLiveLinkComponentSpacePose Pose;
+	ForEachSource([&](FHoudiniLiveLinkSource& Source)
+	{
+		if (Source.GetComponentSpacePose(InSubjectName, Pose) && (!bFound || Pose.Time > OutPose.Time))
+		{
+			OutPose = MoveTemp(Pose);
+			bFound = true;
+		}
+	});
+
+	return bFound;
+}
+
+TSharedPtr<const FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe>
+FHoudiniLiveLinkSource::GetBoneMap(const FHoudiniLiveLinkSkeleton& Skeleton)
+{
+	if (!bHasTargetLayout && Options.BoneNameMap.Num() <= 0)
+		return nullptr;
+
+	// Called by every receive thread
+	FScopeLock Lock(&BoneMapCacheLock);
+	if (const TSharedPtr<const FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe>* CachedMap = BoneMapCache.Find(Skeleton.Hash))
+		return *CachedMap;
+
+	TSharedRef<FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe> BoneMap = MakeShared<FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe>();
+	BoneMap->Build(Skeleton.StaticData, bHasTargetLayout ? &TargetLayout : nullptr, Options.BoneNameMap);
+
+	BoneMapCache.Add(Skeleton.Hash, BoneMap);
+	return BoneMap;
+}
+
+void
+FHoudiniLiveLinkBoneMap::Build(const FLiveLinkSkeletonStaticData& Source, const FHoudiniLiveLinkTargetLayout* TargetLayout, const TMap<FName, FName>& BoneNameMap)
+{
+	const int32 NumSourceBones = Source.BoneNames.Num();
+
+	// Output bone -> Houdini bone
+	TArray<int32> OutputToSource;
+	if (TargetLayout)
+	{
+		// Houdini bones, by the name they have in the target skeleton
+		TMap<FName, int32> SourceIndices;
+		for (int32 BoneIdx = 0; BoneIdx < NumSourceBones; ++BoneIdx)
+		{
+			const FName* MappedName = BoneNameMap.Find(Source.BoneNames[BoneIdx]);
+			SourceIndices.Add(MappedName ? *MappedName : Source.BoneNames[BoneIdx], BoneIdx);
+		}
+
+		BoneNames = TargetLayout->BoneNames;
+		BoneParents = TargetLayout->BoneParents;
+		RefPose = TargetLayout->RefPose;
+		for (const FName& TargetName : TargetLayout->BoneNames)
+		{
+			const int32* SourceIdx = SourceIndices.Find(TargetName);
+			OutputToSource.Add(SourceIdx ? *SourceIdx : INDEX_NONE);
+		}
+	}
+	else
+	{
+		// Only keep the mapped bones, renamed, parented to their closest mapped ancestor
+		TArray<int32> SourceToOutput;
+		SourceToOutput.Init(INDEX_NONE, NumSourceBones);
+		for (int32 BoneIdx = 0; BoneIdx < NumSourceBones; ++BoneIdx)
+		{
+			const FName* MappedName = BoneNameMap.Find(Source.BoneNames[BoneIdx]);
+			if (!MappedName)
+				continue;
+
+			SourceToOutput[BoneIdx] = OutputToSource.Add(BoneIdx);
+			BoneNames.Add(*MappedName);
+		}
+
+		for (int32 SourceIdx : OutputToSource)
+		{
+			int32 Parent = Source.BoneParents[SourceIdx];
+			for (int32 Depth = 0; Parent != INDEX_NONE && SourceToOutput.IsValidIndex(Parent) && SourceToOutput[Parent] == INDEX_NONE && Depth < NumSourceBones; ++Depth)
+			{
+				Parent = Source.BoneParents[Parent];
+			}
+
+			BoneParents.Add(SourceToOutput.IsValidIndex(Parent) ? SourceToOutput[Parent] : INDEX_NONE);
+		}
+
+		RefPose.Init(FTransform::Identity, OutputToSource.Num());
+	}
+
+	// Chains of Houdini bones between each output bone and its output parent
+	TArray<int32> Chain;
+	for (int32 OutputIdx = 0; OutputIdx < OutputToSource.Num(); ++OutputIdx)
+	{
+		ChainStart.Add(ChainIndices.Num());
+
+		const int32 SourceIdx = OutputToSource[OutputIdx];
+		if (SourceIdx == INDEX_NONE)
+			continue;
+
+		// Closest output ancestor that exists in Houdini, the target bones in between keep their RefPose
+		FTransform ParentOffset = FTransform::Identity;
+		bool bHasParentOffset = false;
+		int32 OutputParent = BoneParents[OutputIdx];
+		for (int32 Depth = 0; BoneParents.IsValidIndex(OutputParent) && OutputToSource[OutputParent] == INDEX_NONE && Depth < OutputToSource.Num(); ++Depth)
+		{
+			ParentOffset = ParentOffset * RefPose[OutputParent];
+			bHasParentOffset = true;
+			OutputParent = BoneParents[OutputParent];
+		}
+		const int32 SourceParent = BoneParents.IsValidIndex(OutputParent) ? OutputToSource[OutputParent] : INDEX_NONE;
+
+		Chain.Reset();
+		int32 ChainBone = SourceIdx;
+		while (Source.BoneParents.IsValidIndex(ChainBone) && ChainBone != SourceParent && Chain.Num() < NumSourceBones)
+		{
+			Chain.Add(ChainBone);
+			ChainBone = Source.BoneParents[ChainBone];
+		}
+
+		if (ChainBone != SourceParent)
+		{
+			// The output parent isn't an ancestor of the bone in Houdini, use its local transform as is
+			Chain.Reset();
+			Chain.Add(SourceIdx);
+		}
+		else if (bHasParentOffset)
+		{
+			// The chain is relative to the mapped ancestor, remove the unmapped parents' RefPoses from it
+			if (ParentOffsets.Num() == 0)
+				ParentOffsets.Init(FTransform::Identity, OutputToSource.Num());
+
+			ParentOffsets[OutputIdx] = ParentOffset.Inverse();
+		}
+
+		for (int32 ChainIdx = Chain.Num() - 1; ChainIdx >= 0; --ChainIdx)
+		{
+			ChainIndices.Add(Chain[ChainIdx]);
+		}
+	}
+	ChainStart.Add(ChainIndices.Num());
+}
+
+void
+FHoudiniLiveLinkBoneMap::Apply(const TArray<FTransform>& InTransforms, TArray<FTransform>& OutTransforms) const
+{
+	const int32 NumBones = BoneNames.Num();
+	OutTransforms.SetNumUninitialized(NumBones, false);
+
+	for (int32 BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+	{
+		const int32 Start = ChainStart[BoneIdx];
+		const int32 End = ChainStart[BoneIdx + 1];
+		if (Start == End)
+		{
+			OutTransforms[BoneIdx] = RefPose[BoneIdx];
+			continue;
+		}
+
+		FTransform Transform = InTransforms[ChainIndices[Start]];
+		for (int32 ChainIdx = Start + 1; ChainIdx < End; ++ChainIdx)
+		{
+			Transform = InTransforms[ChainIndices[ChainIdx]] * Transform;
+		}
+
+		if (ParentOffsets.Num() > 0)
+			Transform = Transform * ParentOffsets[BoneIdx];
+
+		OutTransforms[BoneIdx] = Transform;
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -1,70 +1,83 @@
-/*
-* Copyright (c) <2020> Side Effects Software Inc.
-* All rights reserved.
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions are met:
-*
-* 1. Redistributions of source code must retain the above copyright notice,
-*    this list of conditions and the following disclaimer.
-*
-* 2. The name of Side Effects Software may not be used to endorse or
-*    promote products derived from this software without specific prior
-*    written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
-* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
-* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
-* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
-* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
-* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*/
-
-#include "HoudiniLiveLinkSourceFactory.h"
-#include "HoudiniLiveLinkSource.h"
-#include "SHoudiniLiveLinkSourceFactory.h"
-
-#define LOCTEXT_NAMESPACE "HoudiniLiveLinkSourceFactory"
-
-FText 
-UHoudiniLiveLinkSourceFactory::GetSourceDisplayName() const
-{
-	return LOCTEXT("SourceDisplayName", "Houdini LiveLink");
-}
-
-FText 
-UHoudiniLiveLinkSourceFactory::GetSourceTooltip() const
-{
-	return LOCTEXT("SourceTooltip", "Creates a LiveLink connection to Houdini");
-}
-
-TSharedPtr<SWidget> 
-UHoudiniLiveLinkSourceFactory::BuildCreationPanel(FOnLiveLinkSourceCreated InOnLiveLinkSourceCreated) const
-{
-	return SNew(SHoudiniLiveLinkSourceFactory)
-		.OnOkClicked(SHoudiniLiveLinkSourceFactory::FOnOkClicked::CreateUObject(this, &UHoudiniLiveLinkSourceFactory::OnOkClicked, InOnLiveLinkSourceCreated));
-}
-
-TSharedPtr<ILiveLinkSource> 
-UHoudiniLiveLinkSourceFactory::CreateSource(const FString& InConnectionString) const
-{
-	FIPv4Endpoint DeviceEndPoint;
-	if (!FIPv4Endpoint::Parse(InConnectionString, DeviceEndPoint))
-	{
-		return TSharedPtr<ILiveLinkSource>();
-	}
-
-	return MakeShared<FHoudiniLiveLinkSource>(DeviceEndPoint, 60.0f, TEXT("Houdini Subject"));
-}
-
-void 
-UHoudiniLiveLinkSourceFactory::OnOkClicked(FIPv4Endpoint InEndpoint, float InRefreshRate, FString InSubjectName, FOnLiveLinkSourceCreated InOnLiveLinkSourceCreated) const
-{
-	InOnLiveLinkSourceCreated.ExecuteIfBound(MakeShared<FHoudiniLiveLinkSource>(InEndpoint, InRefreshRate, InSubjectName), InEndpoint.ToString());
-}
-
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "HoudiniLiveLinkSourceFactory.h"
+#include "HoudiniLiveLinkSource.h"
+#include "SHoudiniLiveLinkSourceFactory.h"
+
+#define LOCTEXT_NAMESPACE "HoudiniLiveLinkSourceFactory"
+
+FText 
+UHoudiniLiveLinkSourceFactory::GetSourceDisplayName() const
+{
+	return LOCTEXT("SourceDisplayName", "Houdini LiveLink");
+}
+
+FText 
+UHoudiniLiveLinkSourceFactory::GetSourceTooltip() const
+{
+	return LOCTEXT("SourceTooltip", "Creates a LiveLink connection to Houdini");
+}
+
+TSharedPtr<SWidget> 
+UHoudiniLiveLinkSourceFactory::BuildCreationPanel(FOnLiveLinkSourceCreated InOnLiveLinkSourceCreated) const
+{
+	return SNew(SHoudiniLiveLinkSourceFactory)
+		.OnOkClicked(SHoudiniLiveLinkSourceFactory::FOnOkClicked::CreateUObject(this, &UHoudiniLiveLinkSourceFactory::OnOkClicked, InOnLiveLinkSourceCreated));
+}
+
+TSharedPtr<ILiveLinkSource> 
+UHoudiniLiveLinkSourceFactory::CreateSource(const FString& InConnectionString) const
+{
+	// The connection string is the endpoint, optionally followed by the source options
+	FString EndpointString = InConnectionString;
+	FString OptionsString;
+	InConnectionString.Split(TEXT(" "), &EndpointString, &OptionsString);
+
+	FIPv4Endpoint DeviceEndPoint;
+	if (!FIPv4Endpoint::Parse(EndpointString, DeviceEndPoint))
+	{
+		return TSharedPtr<ILiveLinkSource>();
+	}
+
+	FHoudiniLiveLinkSourceOptions Options;
+	FHoudiniLiveLinkSourceOptions::Parse(OptionsString, Options);
+
+	return MakeShared<FHoudiniLiveLinkSource>(DeviceEndPoint, 60.0f, TEXT("Houdini Subject"), Options);
+}
+
+void 
+UHoudiniLiveLinkSourceFactory::OnOkClicked(FIPv4Endpoint InEndpoint, float InRefreshRate, FString InSubjectName, FHoudiniLiveLinkSourceOptions InOptions, FOnLiveLinkSourceCreated InOnLiveLinkSourceCreated) const
+{
+	FString ConnectionString = InEndpoint.ToString();
+	const FString OptionsString = InOptions.ToString();
+	if (!OptionsString.IsEmpty())
+		ConnectionString += TEXT(" ") + OptionsString;
+
+	InOnLiveLinkSourceCreated.ExecuteIfBound(MakeShared<FHoudiniLiveLinkSource>(InEndpoint, InRefreshRate, InSubjectName, InOptions), ConnectionString);
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
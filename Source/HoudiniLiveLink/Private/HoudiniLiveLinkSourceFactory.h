@@ -1,52 +1,53 @@
-/*
-* Copyright (c) <2020> Side Effects Software Inc.
-* All rights reserved.
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions are met:
-*
-* 1. Redistributions of source code must retain the above copyright notice,
-*    this list of conditions and the following disclaimer.
-*
-* 2. The name of Side Effects Software may not be used to endorse or
-*    promote products derived from this software without specific prior
-*    written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
-* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
-* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
-* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
-* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
-* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*/
-
-#pragma once
-
-#include "LiveLinkSourceFactory.h"
-#include "Interfaces/IPv4/IPv4Endpoint.h"
-#include "HoudiniLiveLinkSourceFactory.generated.h"
-
-class SHoudiniLiveLinkSourceEditor;
-
-UCLASS()
-class UHoudiniLiveLinkSourceFactory : public ULiveLinkSourceFactory
-{
-	public:
-
-		GENERATED_BODY()
-
-		virtual FText GetSourceDisplayName() const override;
-		virtual FText GetSourceTooltip() const override;
-
-		virtual EMenuType GetMenuType() const override { return EMenuType::SubPanel; }
-		virtual TSharedPtr<SWidget> BuildCreationPanel(FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const override;
-		TSharedPtr<ILiveLinkSource> CreateSource(const FString& ConnectionString) const override;
-	
-	private:
-
-		void OnOkClicked(FIPv4Endpoint Endpoint, float InRefreshRate, FString InSubjectName, FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const;
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "LiveLinkSourceFactory.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "HoudiniLiveLinkSource.h"
+#include "HoudiniLiveLinkSourceFactory.generated.h"
+
+class SHoudiniLiveLinkSourceEditor;
+
+UCLASS()
+class UHoudiniLiveLinkSourceFactory : public ULiveLinkSourceFactory
+{
+	public:
+
+		GENERATED_BODY()
+
+		virtual FText GetSourceDisplayName() const override;
+		virtual FText GetSourceTooltip() const override;
+
+		virtual EMenuType GetMenuType() const override { return EMenuType::SubPanel; }
+		virtual TSharedPtr<SWidget> BuildCreationPanel(FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const override;
+		TSharedPtr<ILiveLinkSource> CreateSource(const FString& ConnectionString) const override;
+	
+	private:
+
+		void OnOkClicked(FIPv4Endpoint Endpoint, float InRefreshRate, FString InSubjectName, FHoudiniLiveLinkSourceOptions InOptions, FOnLiveLinkSourceCreated OnLiveLinkSourceCreated) const;
 };
\ No newline at end of file
@@ -1,204 +1,488 @@
-/*
-* Copyright (c) <2020> Side Effects Software Inc.
-* All rights reserved.
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions are met:
-*
-* 1. Redistributions of source code must retain the above copyright notice,
-*    this list of conditions and the following disclaimer.
-*
-* 2. The name of Side Effects Software may not be used to endorse or
-*    promote products derived from this software without specific prior
-*    written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
-* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
-* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
-* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
-* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
-* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*/
-
-#include "SHoudiniLiveLinkSourceFactory.h"
-#include "Interfaces/IPv4/IPv4Endpoint.h"
-#include "Widgets/SBoxPanel.h"
-#include "Widgets/Input/SButton.h"
-#include "Widgets/Input/SEditableTextBox.h"
-#include "Widgets/Layout/SBox.h"
-#include "Widgets/Text/STextBlock.h"
-
-#define LOCTEXT_NAMESPACE "HoudiniLiveLinkSourceEditor"
-
-void 
-SHoudiniLiveLinkSourceFactory::Construct(const FArguments& Args)
-{
-	OkClicked = Args._OnOkClicked;
-	
-	// Default to 127.0.0.1:8010
-	FIPv4Endpoint Endpoint;
-	Endpoint.Address = FIPv4Address::InternalLoopback;
-	Endpoint.Port = 8010;
-
-	// Default to 60Fps
-	RefreshValue = 60.0f;
-
-	// Default to HoudiniSubject
-	SubjectName = TEXT("Houdini Subject");
-
-	ChildSlot
-	[
-		SNew(SBox)
-		.WidthOverride(250)
-		[
-			SNew(SVerticalBox)
-			+ SVerticalBox::Slot()
-			.Padding(2, 2, 5, 2)
-			.AutoHeight()
-			[
-				SNew(SHorizontalBox)
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Left)
-				.FillWidth(0.5f)
-				[
-					SNew(STextBlock)
-					.Text(LOCTEXT("HoudiniLLPortNumber", "Port Number"))
-				]
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Fill)
-				.FillWidth(0.5f)
-				[
-					SAssignNew(PortEditabledText, SEditableTextBox)
-					.Text(FText::FromString(Endpoint.ToString()))
-					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnEndpointChanged)
-				]
-			]
-			+ SVerticalBox::Slot()
-			.Padding(2, 2, 5, 2)
-			.AutoHeight()
-			[
-				SNew(SHorizontalBox)
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Left)
-				.FillWidth(0.5f)
-				[
-					SNew(STextBlock)
-					.Text(LOCTEXT("HoudiniLLSubjectName", "Subject Name"))
-				]
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Fill)
-				.FillWidth(0.5f)
-				[
-					SAssignNew(NameEditabledText, SEditableTextBox)
-					.Text(FText::FromString(SubjectName))
-					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnNameChanged)
-				]
-			]
-			+ SVerticalBox::Slot()
-			.Padding(2, 2, 5, 2)
-			.AutoHeight()
-			[
-				SNew(SHorizontalBox)
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Left)
-				.FillWidth(0.5f)
-				[
-					SNew(STextBlock)
-					.Text(LOCTEXT("HoudiniLLRefresh", "Refresh Rate (fps)"))
-				]
-				+ SHorizontalBox::Slot()
-				.HAlign(HAlign_Fill)
-				.FillWidth(0.5f)
-				[
-					SAssignNew(NumericValue, SNumericEntryBox<float>)
-					.AllowSpin(true)
-					.MinValue(0.1)
-					.MinSliderValue(0.1)
-					.MaxSliderValue(144)
-					.Value(this, &SHoudiniLiveLinkSourceFactory::GetRefreshRate)
-					.OnValueChanged(this, &SHoudiniLiveLinkSourceFactory::SetRefreshRate)
-					.SliderExponent(1.0f)
-				]
-			]
-			+ SVerticalBox::Slot()
-			.Padding(2, 2, 5, 2)
-			.HAlign(HAlign_Right)
-			.AutoHeight()
-			[
-				SNew(SButton)
-				.OnClicked(this, &SHoudiniLiveLinkSourceFactory::OnOkClicked)
-				[
-					SNew(STextBlock)
-					.Text(LOCTEXT("Add", "Add Source"))
-				]
-			]
-		]
-	];
-}
-
-void 
-SHoudiniLiveLinkSourceFactory::OnEndpointChanged(const FText& NewValue, ETextCommit::Type)
-{
-	TSharedPtr<SEditableTextBox> EditabledTextPin = PortEditabledText.Pin();
-	if (EditabledTextPin.IsValid())
-	{
-		FIPv4Endpoint Endpoint;
-		if (!FIPv4Endpoint::Parse(NewValue.ToString(), Endpoint))
-		{
-			Endpoint.Address = FIPv4Address::InternalLoopback;
-			Endpoint.Port = 8010;
-			EditabledTextPin->SetText(FText::FromString(Endpoint.ToString()));
-		}
-	}
-}
-
-
-void
-SHoudiniLiveLinkSourceFactory::OnNameChanged(const FText& NewValue, ETextCommit::Type)
-{
-	TSharedPtr<SEditableTextBox> EditabledTextPin = NameEditabledText.Pin();
-	if (EditabledTextPin.IsValid())
-	{
-		FString NewName = NewValue.ToString();
-		if (NewName.IsEmpty())
-		{
-			NewName = TEXT("Houdini Subject");
-			EditabledTextPin->SetText(FText::FromString(NewName));
-		}
-
-		SubjectName = NewName;
-	}
-}
-
-void 
-SHoudiniLiveLinkSourceFactory::SetRefreshRate(float InRefreshRate)
-{
-	RefreshValue = InRefreshRate;
-}
-
-TOptional<float> 
-SHoudiniLiveLinkSourceFactory::GetRefreshRate() const
-{
-	return RefreshValue;
-}
-
-FReply
-SHoudiniLiveLinkSourceFactory::OnOkClicked()
-{
-	TSharedPtr<SEditableTextBox> EditabledTextPin = PortEditabledText.Pin();
-	if (EditabledTextPin.IsValid())
-	{
-		FIPv4Endpoint Endpoint;
-		if (FIPv4Endpoint::Parse(EditabledTextPin->GetText().ToString(), Endpoint))
-		{
-			OkClicked.ExecuteIfBound(Endpoint, RefreshValue, SubjectName);
-		}
-	}
-	return FReply::Handled();
-}
-
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "SHoudiniLiveLinkSourceFactory.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Input/SEditableTextBox.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "HoudiniLiveLinkSourceEditor"
+
+void 
+SHoudiniLiveLinkSourceFactory::Construct(const FArguments& Args)
+{
+	OkClicked = Args._OnOkClicked;
+	
+	// Default to 127.0.0.1:8010
+	FIPv4Endpoint Endpoint;
+	Endpoint.Address = FIPv4Address::InternalLoopback;
+	Endpoint.Port = 8010;
+
+	// Default to 60Fps
+	RefreshValue = 60.0f;
+
+	// Default to HoudiniSubject
+	SubjectName = TEXT("Houdini Subject");
+
+	ChildSlot
+	[
+		SNew(SBox)
+		.WidthOverride(250)
+		[
+			SNew(SVerticalBox)
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLPortNumber", "Port Number"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(PortEditabledText, SEditableTextBox)
+					.Text(FText::FromString(Endpoint.ToString()))
+					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnEndpointChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLSubjectName", "Subject Name"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(NameEditabledText, SEditableTextBox)
+					.Text(FText::FromString(SubjectName))
+					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnNameChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLRefresh", "Refresh Rate (fps)"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(NumericValue, SNumericEntryBox<float>)
+					.AllowSpin(true)
+					.MinValue(0.1)
+					.MinSliderValue(0.1)
+					.MaxSliderValue(144)
+					.Value(this, &SHoudiniLiveLinkSourceFactory::GetRefreshRate)
+					.OnValueChanged(this, &SHoudiniLiveLinkSourceFactory::SetRefreshRate)
+					.SliderExponent(1.0f)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLMulticastGroup", "Multicast Group"))
+					.ToolTipText(LOCTEXT("HoudiniLLMulticastGroupTooltip", "Multicast group to join (224.0.0.0 to 239.255.255.255). Leave empty to only receive unicast packets."))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(MulticastGroupEditabledText, SEditableTextBox)
+					.HintText(LOCTEXT("HoudiniLLMulticastGroupHint", "Unicast"))
+					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnMulticastGroupChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLMulticastInterface", "Multicast Interface"))
+					.ToolTipText(LOCTEXT("HoudiniLLMulticastInterfaceTooltip", "Address of the local interface used to join the group. Leave empty to let the system choose."))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SAssignNew(MulticastInterfaceEditabledText, SEditableTextBox)
+					.HintText(LOCTEXT("HoudiniLLMulticastInterfaceHint", "Any"))
+					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnMulticastInterfaceChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLMulticastTtl", "Multicast TTL"))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SNew(SNumericEntryBox<int32>)
+					.AllowSpin(true)
+					.MinValue(0)
+					.MaxValue(255)
+					.MinSliderValue(0)
+					.MaxSliderValue(32)
+					.Value(this, &SHoudiniLiveLinkSourceFactory::GetMulticastTtl)
+					.OnValueChanged(this, &SHoudiniLiveLinkSourceFactory::SetMulticastTtl)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLCaptureBuffer", "Capture Buffer (frames)"))
+					.ToolTipText(LOCTEXT("HoudiniLLCaptureBufferTooltip", "Number of frames stored at the rate they are received, for export. 0 disables capture."))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SNew(SNumericEntryBox<int32>)
+					.AllowSpin(true)
+					.MinValue(0)
+					.MinSliderValue(0)
+					.MaxSliderValue(240 * 60)
+					.Value(this, &SHoudiniLiveLinkSourceFactory::GetCaptureBufferSize)
+					.OnValueChanged(this, &SHoudiniLiveLinkSourceFactory::SetCaptureBufferSize)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLReceiveThreads", "Receive Threads"))
+					.ToolTipText(LOCTEXT("HoudiniLLReceiveThreadsTooltip", "Number of sockets/threads receiving on the port, the senders are spread between them. Unicast only, not available on Windows."))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SNew(SNumericEntryBox<int32>)
+					.AllowSpin(true)
+					.MinValue(1)
+					.MinSliderValue(1)
+					.MaxSliderValue(16)
+					.Value(this, &SHoudiniLiveLinkSourceFactory::GetNumReceiveThreads)
+					.OnValueChanged(this, &SHoudiniLiveLinkSourceFactory::SetNumReceiveThreads)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLTargetSkeleton", "Target Skeleton"))
+					.ToolTipText(LOCTEXT("HoudiniLLTargetSkeletonTooltip", "Object path of a skeleton asset. Frames are pushed reordered to its bones, bones missing from Houdini use its reference pose."))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SNew(SEditableTextBox)
+					.HintText(LOCTEXT("HoudiniLLTargetSkeletonHint", "None"))
+					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnTargetSkeletonChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLBoneNameMap", "Bone Name Map"))
+					.ToolTipText(LOCTEXT("HoudiniLLBoneNameMapTooltip", "Houdini bones renamed to their target name, as HoudiniName:TargetName pairs separated by commas. Without a target skeleton, only these bones are pushed."))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SNew(SEditableTextBox)
+					.HintText(LOCTEXT("HoudiniLLBoneNameMapHint", "None"))
+					.OnTextCommitted(this, &SHoudiniLiveLinkSourceFactory::OnBoneNameMapChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.AutoHeight()
+			[
+				SNew(SHorizontalBox)
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Left)
+				.FillWidth(0.5f)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("HoudiniLLComponentSpace", "Component Space Pose"))
+					.ToolTipText(LOCTEXT("HoudiniLLComponentSpaceTooltip", "Also compute the component space transforms of every frame, read with GetComponentSpacePose()."))
+				]
+				+ SHorizontalBox::Slot()
+				.HAlign(HAlign_Fill)
+				.FillWidth(0.5f)
+				[
+					SNew(SCheckBox)
+					.IsChecked(this, &SHoudiniLiveLinkSourceFactory::IsComputeComponentSpaceChecked)
+					.OnCheckStateChanged(this, &SHoudiniLiveLinkSourceFactory::OnComputeComponentSpaceChanged)
+				]
+			]
+			+ SVerticalBox::Slot()
+			.Padding(2, 2, 5, 2)
+			.HAlign(HAlign_Right)
+			.AutoHeight()
+			[
+				SNew(SButton)
+				.OnClicked(this, &SHoudiniLiveLinkSourceFactory::OnOkClicked)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("Add", "Add Source"))
+				]
+			]
+		]
+	];
+}
+
+void 
+SHoudiniLiveLinkSourceFactory::OnEndpointChanged(const FText& NewValue, ETextCommit::Type)
+{
+	TSharedPtr<SEditableTextBox> EditabledTextPin = PortEditabledText.Pin();
+	if (EditabledTextPin.IsValid())
+	{
+		FIPv4Endpoint Endpoint;
+		if (!FIPv4Endpoint::Parse(NewValue.ToString(), Endpoint))
+		{
+			Endpoint.Address = FIPv4Address::InternalLoopback;
+			Endpoint.Port = 8010;
+			EditabledTextPin->SetText(FText::FromString(Endpoint.ToString()));
+		}
+	}
+}
+
+
+void
+SHoudiniLiveLinkSourceFactory::OnNameChanged(const FText& NewValue, ETextCommit::Type)
+{
+	TSharedPtr<SEditableTextBox> EditabledTextPin = NameEditabledText.Pin();
+	if (EditabledTextPin.IsValid())
+	{
+		FString NewName = NewValue.ToString();
+		if (NewName.IsEmpty())
+		{
+			NewName = TEXT("Houdini Subject");
+			EditabledTextPin->SetText(FText::FromString(NewName));
+		}
+
+		SubjectName = NewName;
+	}
+}
+
+void
+SHoudiniLiveLinkSourceFactory::OnMulticastGroupChanged(const FText& NewValue, ETextCommit::Type)
+{
+	TSharedPtr<SEditableTextBox> EditabledTextPin = MulticastGroupEditabledText.Pin();
+	if (EditabledTextPin.IsValid())
+	{
+		// Anything that isn't a multicast address means unicast
+		FIPv4Address Group;
+		if (!FIPv4Address::Parse(NewValue.ToString(), Group) || !Group.IsMulticastAddress())
+		{
+			Group = FIPv4Address::Any;
+			EditabledTextPin->SetText(FText::GetEmpty());
+		}
+
+		Options.MulticastGroup = Group;
+	}
+}
+
+void
+SHoudiniLiveLinkSourceFactory::OnMulticastInterfaceChanged(const FText& NewValue, ETextCommit::Type)
+{
+	TSharedPtr<SEditableTextBox> EditabledTextPin = MulticastInterfaceEditabledText.Pin();
+	if (EditabledTextPin.IsValid())
+	{
+		FIPv4Address Interface;
+		if (!FIPv4Address::Parse(NewValue.ToString(), Interface))
+		{
+			Interface = FIPv4Address::Any;
+			EditabledTextPin->SetText(FText::GetEmpty());
+		}
+
+		Options.MulticastInterface = Interface;
+	}
+}
+
+void
+SHoudiniLiveLinkSourceFactory::SetMulticastTtl(int32 InTtl)
+{
+	Options.MulticastTtl = (uint8)FMath::Clamp(InTtl, 0, 255);
+}
+
+TOptional<int32>
+SHoudiniLiveLinkSourceFactory::GetMulticastTtl() const
+{
+	return (int32)Options.MulticastTtl;
+}
+
+void
+SHoudiniLiveLinkSourceFactory::OnTargetSkeletonChanged(const FText& NewValue, ETextCommit::Type)
+{
+	Options.TargetSkeleton = NewValue.ToString().TrimStartAndEnd();
+}
+
+void
+SHoudiniLiveLinkSourceFactory::OnBoneNameMapChanged(const FText& NewValue, ETextCommit::Type)
+{
+	FHoudiniLiveLinkSourceOptions::ParseBoneNameMap(NewValue.ToString(), Options.BoneNameMap);
+}
+
+void
+SHoudiniLiveLinkSourceFactory::SetCaptureBufferSize(int32 InSize)
+{
+	Options.CaptureBufferSize = FMath::Max(InSize, 0);
+}
+
+TOptional<int32>
+SHoudiniLiveLinkSourceFactory::GetCaptureBufferSize() const
+{
+	return Options.CaptureBufferSize;
+}
+
+void
+SHoudiniLiveLinkSourceFactory::SetNumReceiveThreads(int32 InNumThreads)
+{
+	Options.NumReceiveThreads = FMath::Max(InNumThreads, 1);
+}
+
+TOptional<int32>
+SHoudiniLiveLinkSourceFactory::GetNumReceiveThreads() const
+{
+	return Options.NumReceiveThreads;
+}
+
+void
+SHoudiniLiveLinkSourceFactory::OnComputeComponentSpaceChanged(ECheckBoxState NewState)
+{
+	Options.bComputeComponentSpace = NewState == ECheckBoxState::Checked;
+}
+
+ECheckBoxState
+SHoudiniLiveLinkSourceFactory::IsComputeComponentSpaceChecked() const
+{
+	return Options.bComputeComponentSpace ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void 
+SHoudiniLiveLinkSourceFactory::SetRefreshRate(float InRefreshRate)
+{
+	RefreshValue = InRefreshRate;
+}
+
+TOptional<float> 
+SHoudiniLiveLinkSourceFactory::GetRefreshRate() const
+{
+	return RefreshValue;
+}
+
+FReply
+SHoudiniLiveLinkSourceFactory::OnOkClicked()
+{
+	TSharedPtr<SEditableTextBox> EditabledTextPin = PortEditabledText.Pin();
+	if (EditabledTextPin.IsValid())
+	{
+		FIPv4Endpoint Endpoint;
+		if (FIPv4Endpoint::Parse(EditabledTextPin->GetText().ToString(), Endpoint))
+		{
+			OkClicked.ExecuteIfBound(Endpoint, RefreshValue, SubjectName, Options);
+		}
+	}
+	return FReply::Handled();
+}
+
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
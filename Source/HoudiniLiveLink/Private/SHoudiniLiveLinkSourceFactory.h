@@ -1,27 +1,27 @@
-/*
-* Copyright (c) <2020> Side Effects Software Inc.
-* All rights reserved.
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions are met:
-*
-* 1. Redistributions of source code must retain the above copyright notice,
-*    this list of conditions and the following disclaimer.
-*
-* 2. The name of Side Effects Software may not be used to endorse or
-*    promote products derived from this software without specific prior
-*    written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
-* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
-* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
-* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
-* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
-* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #pragma once
@@ -32,6 +32,8 @@
 #include "Widgets/DeclarativeSyntaxSupport.h"
 #include "Interfaces/IPv4/IPv4Endpoint.h"
 #include "Widgets/Input/SNumericEntryBox.h"
+#include "Styling/SlateTypes.h"
+#include "HoudiniLiveLinkSource.h"
 
 class SEditableTextBox;
 
@@ -39,7 +41,7 @@ class SHoudiniLiveLinkSourceFactory : public SCompoundWidget
 {
 	public:
 
-		DECLARE_DELEGATE_ThreeParams(FOnOkClicked, FIPv4Endpoint, float, FString);
+		DECLARE_DELEGATE_FourParams(FOnOkClicked, FIPv4Endpoint, float, FString, FHoudiniLiveLinkSourceOptions);
 
 		SLATE_BEGIN_ARGS(SHoudiniLiveLinkSourceFactory){}
 			SLATE_EVENT(FOnOkClicked, OnOkClicked)
@@ -53,6 +55,24 @@ class SHoudiniLiveLinkSourceFactory : public SCompoundWidget
 
 		void OnNameChanged(const FText& NewValue, ETextCommit::Type);
 
+		void OnMulticastGroupChanged(const FText& NewValue, ETextCommit::Type);
+		void OnMulticastInterfaceChanged(const FText& NewValue, ETextCommit::Type);
+
+		void SetMulticastTtl(int32 InTtl);
+		TOptional<int32> GetMulticastTtl() const;
+
+		void OnTargetSkeletonChanged(const FText& NewValue, ETextCommit::Type);
+		void OnBoneNameMapChanged(const FText& NewValue, ETextCommit::Type);
+
+		void SetCaptureBufferSize(int32 InSize);
+		TOptional<int32> GetCaptureBufferSize() const;
+
+		void SetNumReceiveThreads(int32 InNumThreads);
+		TOptional<int32> GetNumReceiveThreads() const;
+
+		void OnComputeComponentSpaceChanged(ECheckBoxState NewState);
+		ECheckBoxState IsComputeComponentSpaceChecked() const;
+
 		void SetRefreshRate(float InRefreshRate);
 		TOptional<float> GetRefreshRate() const;
 
@@ -63,8 +83,12 @@ class SHoudiniLiveLinkSourceFactory : public SCompoundWidget
 		TWeakPtr<SEditableTextBox> PortEditabledText;
 		TWeakPtr<SEditableTextBox> NameEditabledText;
 		TWeakPtr<SNumericEntryBox<float>> NumericValue;
+		TWeakPtr<SEditableTextBox> MulticastGroupEditabledText;
+		TWeakPtr<SEditableTextBox> MulticastInterfaceEditabledText;
 
 		float RefreshValue;
 
 		FString SubjectName;
+
+		FHoudiniLiveLinkSourceOptions Options;
 };
\ No newline at end of file
@@ -0,0 +1,123 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "Misc/AutomationTest.h"
+
+#include "HoudiniLiveLinkSource.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoudiniLiveLinkBoneMapTest, "Plugins.HoudiniLiveLink.BoneMap", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+// Component space transform of a bone from the local transforms of its layout
+static FTransform
+GetComponentSpaceTransform(const TArray<FTransform>& Transforms, const TArray<int32>& BoneParents, int32 BoneIdx)
+{
+	FTransform Transform = FTransform::Identity;
+	for (int32 Depth = 0; BoneParents.IsValidIndex(BoneIdx) && Depth < BoneParents.Num(); ++Depth)
+	{
+		Transform = Transform * Transforms[BoneIdx];
+		BoneIdx = BoneParents[BoneIdx];
+	}
+
+	return Transform;
+}
+
+bool
+FHoudiniLiveLinkBoneMapTest::RunTest(const FString& Parameters)
+{
+	// Houdini: root > hips > spine > twist > arm
+	FLiveLinkSkeletonStaticData Houdini;
+	Houdini.BoneNames = { TEXT("root"), TEXT("hips"), TEXT("spine"), TEXT("twist"), TEXT("arm") };
+	Houdini.BoneParents = { INDEX_NONE, 0, 1, 2, 3 };
+
+	TArray<FTransform> HoudiniPose;
+	for (int32 BoneIdx = 0; BoneIdx < Houdini.BoneNames.Num(); ++BoneIdx)
+	{
+		HoudiniPose.Add(FTransform(FQuat::MakeFromEuler(FVector(10.0f * BoneIdx, 5.0f, -20.0f * BoneIdx)), FVector(0.0f, 3.0f, 10.0f * BoneIdx)));
+	}
+
+	// Target: root > pelvis > spine_01 > spine_02 > arm, spine_02 doesn't exist in Houdini and twist doesn't exist in the target
+	FHoudiniLiveLinkTargetLayout Target;
+	Target.BoneNames = { TEXT("root"), TEXT("pelvis"), TEXT("spine_01"), TEXT("spine_02"), TEXT("arm") };
+	Target.BoneParents = { INDEX_NONE, 0, 1, 2, 3 };
+	for (int32 BoneIdx = 0; BoneIdx < Target.BoneNames.Num(); ++BoneIdx)
+	{
+		Target.RefPose.Add(FTransform(FQuat::MakeFromEuler(FVector(0.0f, 30.0f, 15.0f * BoneIdx)), FVector(5.0f, 0.0f, 2.0f)));
+	}
+
+	TMap<FName, FName> BoneNameMap;
+	BoneNameMap.Add(TEXT("hips"), TEXT("pelvis"));
+	BoneNameMap.Add(TEXT("spine"), TEXT("spine_01"));
+
+	FHoudiniLiveLinkBoneMap BoneMap;
+	BoneMap.Build(Houdini, &Target, BoneNameMap);
+
+	TArray<FTransform> Pose;
+	BoneMap.Apply(HoudiniPose, Pose);
+	TestEqual(TEXT("Bones in the target layout"), Pose.Num(), Target.BoneNames.Num());
+	if (Pose.Num() != Target.BoneNames.Num())
+		return false;
+
+	TestTrue(TEXT("Unmapped target bone uses its RefPose"), Pose[3].Equals(Target.RefPose[3], KINDA_SMALL_NUMBER));
+
+	// Mapped bones end up where they are in Houdini, whatever is unmapped in between
+	const int32 TargetToHoudini[] = { 0, 1, 2, INDEX_NONE, 4 };
+	for (int32 BoneIdx = 0; BoneIdx < Target.BoneNames.Num(); ++BoneIdx)
+	{
+		if (TargetToHoudini[BoneIdx] == INDEX_NONE)
+			continue;
+
+		const FTransform Expected = GetComponentSpaceTransform(HoudiniPose, Houdini.BoneParents, TargetToHoudini[BoneIdx]);
+		const FTransform Mapped = GetComponentSpaceTransform(Pose, Target.BoneParents, BoneIdx);
+		TestTrue(FString::Printf(TEXT("Component space transform of %s"), *Target.BoneNames[BoneIdx].ToString()), Mapped.Equals(Expected, 1.e-3f));
+	}
+
+	// Without a target, only the mapped bones are kept
+	FHoudiniLiveLinkBoneMap NameMap;
+	NameMap.Build(Houdini, nullptr, BoneNameMap);
+	TestEqual(TEXT("Mapped bones"), NameMap.BoneNames.Num(), 2);
+	TestTrue(TEXT("No parent offsets without a target"), NameMap.ParentOffsets.Num() == 0);
+
+	// The map survives the connection string
+	FHoudiniLiveLinkSourceOptions Options;
+	Options.BoneNameMap = BoneNameMap;
+	Options.BoneNameMap.Add(TEXT("left arm"), TEXT("upperarm_l"));
+
+	FHoudiniLiveLinkSourceOptions Parsed;
+	FHoudiniLiveLinkSourceOptions::Parse(Options.ToString(), Parsed);
+	TestEqual(TEXT("Parsed bone names"), Parsed.BoneNameMap.Num(), Options.BoneNameMap.Num());
+	for (const TPair<FName, FName>& Pair : Options.BoneNameMap)
+	{
+		const FName* ParsedName = Parsed.BoneNameMap.Find(Pair.Key);
+		TestTrue(FString::Printf(TEXT("Parsed %s"), *Pair.Key.ToString()), ParsedName && *ParsedName == Pair.Value);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
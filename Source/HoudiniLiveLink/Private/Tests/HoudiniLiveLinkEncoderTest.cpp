@@ -0,0 +1,250 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "Misc/AutomationTest.h"
+#include "Misc/Compression.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+
+#include "HoudiniLiveLinkEncoder.h"
+#include "HoudiniLiveLinkSource.h"
+#include "../HoudiniLiveLinkReceiver.h"
+
+#include <locale.h>
+#include <math.h>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Encodes frames with FHoudiniLiveLinkEncoder and feeds them to a receiver that isn't started
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoudiniLiveLinkEncoderTest, "Plugins.HoudiniLiveLink.Encoder", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+static int32_t
+HoudiniLiveLinkTestCompress(uint8_t Compression, const void* Src, int32_t SrcSize, void* Dst, int32_t DstCapacity, void* UserData)
+{
+	int32 CompressedSize = DstCapacity;
+	if (Compression != HLL_COMPRESSION_ZLIB || !FCompression::CompressMemory(NAME_Zlib, Dst, CompressedSize, Src, SrcSize))
+		return 0;
+
+	return CompressedSize;
+}
+
+static bool
+RunEncoderRoundTrip(FAutomationTestBase& Test, FHoudiniLiveLinkSource& Source)
+{
+	// The source isn't started (it never gets a client): no socket or thread, the packets are fed to the receiver
+	FHoudiniLiveLinkReceiver Receiver(Source, 1);
+	TSharedRef<FInternetAddr> SenderAddress = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+
+	// Plain JSON packets, from senders that don't write a header, belong to the source's subject
+	{
+		const char* Json = "{\"names\": [\"Root\", \"Arm\"], \"parents\": [-1, 0], \"positions\": [[0, 0, 0], [1, 2, 3]], \"rotations\": [[0, 0, 0], [0, 0, 90]]}";
+		Receiver.ProcessPacket(Json, (int32)strlen(Json), *SenderAddress, FPlatformTime::Seconds());
+
+		const FHoudiniLiveLinkSubjectState* Subject = Receiver.FindSubject(0);
+		if (!Test.TestNotNull(TEXT("JSON subject received"), Subject))
+			return false;
+
+		FLiveLinkAnimationFrameData FrameData;
+		Subject->GetLastFrameData(FrameData);
+		if (!Test.TestEqual(TEXT("Number of JSON bones"), FrameData.Transforms.Num(), 2))
+			return false;
+
+		Test.TestEqual(TEXT("JSON subject name"), Subject->SubjectName, Source.GetSubjectName());
+		Test.TestEqual(TEXT("JSON bone position"), FrameData.Transforms[1].GetLocation(), FVector(1.0f, -2.0f, 3.0f));
+		Test.TestTrue(TEXT("JSON bone rotation"), FrameData.Transforms[1].GetRotation().Equals(FQuat::MakeFromEuler(FVector(0.0f, 0.0f, -90.0f)), KINDA_SMALL_NUMBER));
+
+		// Garbage is ignored
+		const char* Garbage = "{\"names\": [";
+		Receiver.ProcessPacket(Garbage, (int32)strlen(Garbage), *SenderAddress, FPlatformTime::Seconds());
+		Receiver.FindSubject(0)->GetLastFrameData(FrameData);
+		Test.TestEqual(TEXT("Number of bones after garbage"), FrameData.Transforms.Num(), 2);
+	}
+
+	const char* SubjectName = "HoudiniLiveLinkEncoderTest";
+	const uint32 SubjectId = HoudiniLiveLinkSubjectId(SubjectName, (int32_t)strlen(SubjectName));
+
+	FHoudiniLiveLinkEncoder Encoder(0x1234);
+	Encoder.SetSubject(SubjectName);
+
+	auto Receive = [&]()
+	{
+		Receiver.ProcessPacket((const char*)Encoder.GetPacketData(), Encoder.GetPacketSize(), *SenderAddress, FPlatformTime::Seconds());
+		return Receiver.FindSubject(SubjectId);
+	};
+
+	// Non-ASCII names must hash the same on both sides
+	const char* BoneNames[] = { "Root", "Hips", "\xC3\x89paule_Gauche" };
+	const int32_t BoneParents[] = { -1, 0, 1 };
+	const char* CurveNames[] = { "Blink_L", "Blink_R", "Jaw_Open", "Smile" };
+	Encoder.SetSkeleton(BoneNames, BoneParents, 3, CurveNames, 4);
+	Encoder.SetSparseCurves(4);
+
+	float Positions[] = { 0.0f, 0.0f, 0.0f, 1.0f, 2.0f, 3.0f, -4.0f, 5.0f, 6.0f };
+	float Rotations[] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	float Curves[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	FHoudiniLiveLinkFrame Frame;
+	Frame.NumBones = 3;
+	Frame.Positions = Positions;
+	Frame.Rotations = Rotations;
+	Frame.NumCurves = 4;
+	Frame.Curves = Curves;
+
+	// Skeleton hash and positions
+	Test.TestTrue(TEXT("Encode the first frame"), Encoder.EncodeFrame(Frame, true));
+	const FHoudiniLiveLinkSubjectState* Subject = Receive();
+	if (!Test.TestNotNull(TEXT("Subject received"), Subject))
+		return false;
+
+	Test.TestEqual(TEXT("Skeleton hash"), Subject->CurrentSkeleton.Hash, (uint64)Encoder.GetSkeletonHash());
+	Test.TestFalse(TEXT("Skeleton hash accepted"), Subject->bIgnoreSkeletonHash);
+	Test.TestEqual(TEXT("Bone name"), Subject->CurrentSkeleton.BoneNameStrings.Last(), FString(UTF8_TO_TCHAR(BoneNames[2])));
+
+	FLiveLinkAnimationFrameData FrameData;
+	Subject->GetLastFrameData(FrameData);
+	if (!Test.TestEqual(TEXT("Number of bones"), FrameData.Transforms.Num(), 3))
+		return false;
+
+	// Houdini to Unreal: Y is flipped
+	Test.TestEqual(TEXT("Bone position"), FrameData.Transforms[2].GetLocation(), FVector(-4.0f, -5.0f, 6.0f));
+
+	// Sparse curves: the deltas and the full frames that follow them must give the same values
+	for (int32 FrameIdx = 1; FrameIdx < 10; ++FrameIdx)
+	{
+		Curves[FrameIdx % 4] = FrameIdx * 0.1f;
+		Test.TestTrue(TEXT("Encode a curve frame"), Encoder.EncodeFrame(Frame, false));
+		Subject = Receive();
+		Subject->GetLastFrameData(FrameData);
+		Test.TestEqual(FString::Printf(TEXT("Curves of frame %d"), FrameIdx), FrameData.PropertyValues, TArray<float>(Curves, 4));
+	}
+
+	// Compression: a bigger skeleton compressed with zlib
+	const int32 NumBigBones = 64;
+	TArray<TArray<ANSICHAR>> BigBoneNameBuffers;
+	TArray<const char*> BigBoneNames;
+	TArray<int32_t> BigBoneParents;
+	TArray<float> BigPositions;
+	TArray<float> BigRotations;
+	BigBoneNameBuffers.SetNum(NumBigBones);
+	for (int32 BoneIdx = 0; BoneIdx < NumBigBones; ++BoneIdx)
+	{
+		BigBoneNameBuffers[BoneIdx].SetNumZeroed(16);
+		FCStringAnsi::Sprintf(BigBoneNameBuffers[BoneIdx].GetData(), "Bone_%d", BoneIdx);
+		BigBoneNames.Add(BigBoneNameBuffers[BoneIdx].GetData());
+		BigBoneParents.Add(BoneIdx - 1);
+		BigPositions.Append({ 0.0f, 0.1f * BoneIdx, 0.0f });
+		BigRotations.Append({ 0.0f, 0.0f, 0.0f, 1.0f });
+	}
+
+	Encoder.SetSkeleton(BigBoneNames.GetData(), BigBoneParents.GetData(), NumBigBones, CurveNames, 4);
+	Encoder.SetCompression(HLL_COMPRESSION_ZLIB, &HoudiniLiveLinkTestCompress, nullptr);
+
+	// Quaternion rotations
+	Frame.NumBones = NumBigBones;
+	Frame.Positions = BigPositions.GetData();
+	Frame.Rotations = BigRotations.GetData();
+	Frame.RotationSize = 4;
+	Test.TestTrue(TEXT("Encode a compressed frame"), Encoder.EncodeFrame(Frame, true));
+
+	FHoudiniLiveLinkPacketHeader Header;
+	Test.TestTrue(TEXT("Read the header"), HoudiniLiveLinkReadHeader(Encoder.GetPacketData(), Encoder.GetPacketSize(), Header));
+	Test.TestEqual(TEXT("Compression"), (int32)Header.Compression, (int32)HLL_COMPRESSION_ZLIB);
+
+	Subject = Receive();
+	Test.TestEqual(TEXT("Compressed skeleton hash"), Subject->CurrentSkeleton.Hash, (uint64)Encoder.GetSkeletonHash());
+
+	Subject->GetLastFrameData(FrameData);
+	if (!Test.TestEqual(TEXT("Number of compressed bones"), FrameData.Transforms.Num(), NumBigBones))
+		return false;
+
+	Test.TestTrue(TEXT("Identity quaternion"), FrameData.Transforms[1].GetRotation().AngularDistance(FQuat::Identity) < KINDA_SMALL_NUMBER);
+
+	return true;
+}
+
+bool
+FHoudiniLiveLinkEncoderTest::RunTest(const FString& Parameters)
+{
+	// Keep the skeletons the receiver caches out of the project's cache
+	FHoudiniLiveLinkSourceOptions Options;
+	Options.SkeletonCacheDirectory = FPaths::AutomationTransientDir() / TEXT("HoudiniLiveLinkEncoderTest");
+
+	bool bSuccess = false;
+	{
+		FHoudiniLiveLinkSource Source(FIPv4Endpoint(FIPv4Address::Any, 0), 0.0f, FString(), Options);
+		bSuccess = RunEncoderRoundTrip(*this, Source);
+	}
+
+	// The source waits for the cache writes when it is destroyed
+	IFileManager::Get().DeleteDirectory(*Options.SkeletonCacheDirectory, false, true);
+
+	return bSuccess;
+}
+
+// Floats must be written with a '.' whatever the locale of the host application
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoudiniLiveLinkEncoderLocaleTest, "Plugins.HoudiniLiveLink.EncoderLocale", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool
+FHoudiniLiveLinkEncoderLocaleTest::RunTest(const FString& Parameters)
+{
+	auto TestFormat = [this](const TCHAR* What)
+	{
+		char Buffer[32];
+		HoudiniLiveLinkFormatFloat(1.5f, Buffer, sizeof(Buffer));
+		TestEqual(FString::Printf(TEXT("1.5 (%s)"), What), FString(ANSI_TO_TCHAR(Buffer)), FString(TEXT("1.5")));
+		HoudiniLiveLinkFormatFloat(-1.0e-10f, Buffer, sizeof(Buffer));
+		TestEqual(FString::Printf(TEXT("-1e-10 (%s)"), What), FString(ANSI_TO_TCHAR(Buffer)), FString(TEXT("-1.00000001e-10")));
+		HoudiniLiveLinkFormatFloat(NAN, Buffer, sizeof(Buffer));
+		TestEqual(FString::Printf(TEXT("NaN (%s)"), What), FString(ANSI_TO_TCHAR(Buffer)), FString(TEXT("0")));
+	};
+
+	TestFormat(TEXT("current locale"));
+
+	// Comma decimal locales, if one is installed
+	const FString PreviousLocale(ANSI_TO_TCHAR(setlocale(LC_NUMERIC, nullptr)));
+	const char* CommaLocales[] = { "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "German", "French" };
+	bool bTestedCommaLocale = false;
+	for (const char* Locale : CommaLocales)
+	{
+		if (setlocale(LC_NUMERIC, Locale))
+		{
+			TestFormat(ANSI_TO_TCHAR(Locale));
+			bTestedCommaLocale = true;
+			break;
+		}
+	}
+
+	setlocale(LC_NUMERIC, TCHAR_TO_ANSI(*PreviousLocale));
+	if (!bTestedCommaLocale)
+		AddInfo(TEXT("No comma decimal locale installed, only the current locale was tested"));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
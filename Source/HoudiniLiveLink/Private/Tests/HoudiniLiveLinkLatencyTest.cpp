@@ -0,0 +1,130 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+
+#include "HoudiniLiveLinkEncoder.h"
+#include "HoudiniLiveLinkSource.h"
+#include "../HoudiniLiveLinkReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoudiniLiveLinkLatencyTest, "Plugins.HoudiniLiveLink.Latency", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+static void
+RunLatency(FAutomationTestBase& Test, FHoudiniLiveLinkSource& Source)
+{
+	FHoudiniLiveLinkReceiver Receiver(Source, 1);
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TSharedRef<FInternetAddr> SenderAddress = SocketSubsystem->CreateInternetAddr();
+	SenderAddress->SetIp(0x7F000001);
+	SenderAddress->SetPort(5000);
+	TSharedRef<FInternetAddr> OtherAddress = SocketSubsystem->CreateInternetAddr();
+	OtherAddress->SetIp(0x7F000001);
+	OtherAddress->SetPort(5001);
+
+	const char* SubjectName = "HoudiniLiveLinkLatencyTest";
+	const uint32 SubjectId = HoudiniLiveLinkSubjectId(SubjectName, (int32_t)strlen(SubjectName));
+	const uint32 StreamId = 0x1111;
+
+	// A timestamped frame makes its sender the one measured
+	const char* BoneNames[] = { "Root" };
+	const int32_t BoneParents[] = { -1 };
+	const float Positions[] = { 0.0f, 0.0f, 0.0f };
+	const float Rotations[] = { 0.0f, 0.0f, 0.0f };
+
+	FHoudiniLiveLinkFrame Frame;
+	Frame.NumBones = 1;
+	Frame.Positions = Positions;
+	Frame.Rotations = Rotations;
+
+	FHoudiniLiveLinkEncoder Encoder(StreamId);
+	Encoder.SetSubject(SubjectName);
+	Encoder.SetSkeleton(BoneNames, BoneParents, 1, nullptr, 0);
+	Encoder.EncodeFrame(Frame, true, 1000);
+	Receiver.ProcessPacket((const char*)Encoder.GetPacketData(), Encoder.GetPacketSize(), *SenderAddress, FPlatformTime::Seconds());
+
+	const FHoudiniLiveLinkSubjectState* Subject = Receiver.FindSubject(SubjectId);
+	if (!Test.TestNotNull(TEXT("Subject received"), Subject))
+		return;
+
+	Test.TestEqual(TEXT("Measured stream"), Subject->LatencyStreamId, StreamId);
+
+	// Pong answering a ping sent on a given stream
+	auto ReceivePong = [&](uint32 PongStreamId, const FInternetAddr& PongAddress)
+	{
+		uint8 Ping[sizeof(FHoudiniLiveLinkPacketHeader) + sizeof(uint64)];
+		const int32 HeaderSize = HoudiniLiveLinkWriteHeader(Ping, sizeof(Ping), HLL_PACKET_PING, PongStreamId, 0, SubjectId);
+		const uint64 PingTime = (uint64)(FPlatformTime::Seconds() * 1000000.0) - 1000;
+		FMemory::Memcpy(Ping + HeaderSize, &PingTime, sizeof(PingTime));
+
+		uint8 Pong[sizeof(FHoudiniLiveLinkPacketHeader) + sizeof(FHoudiniLiveLinkPingPayload)];
+		const int32 PongSize = HoudiniLiveLinkMakePong(Ping, sizeof(Ping), Pong, sizeof(Pong), 5000, 5000);
+		Receiver.ProcessPacket((const char*)Pong, PongSize, PongAddress, FPlatformTime::Seconds());
+	};
+
+	ReceivePong(StreamId + 1, *SenderAddress);
+	Test.TestFalse(TEXT("Pong from a previous stream ignored"), Subject->ClockSync.HasOffset());
+
+	ReceivePong(StreamId, *OtherAddress);
+	Test.TestFalse(TEXT("Pong from another sender ignored"), Subject->ClockSync.HasOffset());
+
+	ReceivePong(StreamId, *SenderAddress);
+	Test.TestTrue(TEXT("Pong from the sender used"), Subject->ClockSync.HasOffset());
+
+	// The sender restarts: the samples of its previous clock are dropped
+	FHoudiniLiveLinkEncoder RestartedEncoder(StreamId + 1);
+	RestartedEncoder.SetSubject(SubjectName);
+	RestartedEncoder.SetSkeleton(BoneNames, BoneParents, 1, nullptr, 0);
+	RestartedEncoder.EncodeFrame(Frame, true, 2000);
+	Receiver.ProcessPacket((const char*)RestartedEncoder.GetPacketData(), RestartedEncoder.GetPacketSize(), *SenderAddress, FPlatformTime::Seconds());
+	Test.TestEqual(TEXT("Measured stream after a restart"), Subject->LatencyStreamId, StreamId + 1);
+	Test.TestFalse(TEXT("Clock reset after a restart"), Subject->ClockSync.HasOffset());
+
+	ReceivePong(StreamId, *SenderAddress);
+	Test.TestFalse(TEXT("Late pong from before the restart ignored"), Subject->ClockSync.HasOffset());
+}
+
+bool
+FHoudiniLiveLinkLatencyTest::RunTest(const FString& Parameters)
+{
+	FHoudiniLiveLinkSourceOptions Options;
+	Options.SkeletonCacheDirectory = FPaths::AutomationTransientDir() / TEXT("HoudiniLiveLinkLatencyTest");
+	{
+		FHoudiniLiveLinkSource Source(FIPv4Endpoint(FIPv4Address::Any, 0), 0.0f, FString(), Options);
+		RunLatency(*this, Source);
+	}
+
+	IFileManager::Get().DeleteDirectory(*Options.SkeletonCacheDirectory, false, true);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,136 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "Misc/AutomationTest.h"
+
+#include "../HoudiniLiveLinkReceiver.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoudiniLiveLinkSequenceTrackerTest, "Plugins.HoudiniLiveLink.SequenceTracker", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool
+FHoudiniLiveLinkSequenceTrackerTest::RunTest(const FString& Parameters)
+{
+	const uint32 StreamId = 0x1234;
+
+	// Reordered and duplicate frames
+	{
+		FHoudiniLiveLinkSequenceTracker Tracker;
+		TestTrue(TEXT("First frame"), Tracker.Accept(StreamId, 0));
+		TestTrue(TEXT("Newer frame"), Tracker.Accept(StreamId, 1));
+		TestTrue(TEXT("Frame after a gap"), Tracker.Accept(StreamId, 3));
+		TestFalse(TEXT("Reordered frame"), Tracker.Accept(StreamId, 2));
+		TestFalse(TEXT("Duplicate of the reordered frame"), Tracker.Accept(StreamId, 2));
+		TestFalse(TEXT("Duplicate of the last frame"), Tracker.Accept(StreamId, 3));
+		for (uint32 Sequence = 4; Sequence < 100; ++Sequence)
+		{
+			Tracker.Accept(StreamId, Sequence);
+		}
+
+		const FHoudiniLiveLinkStreamStats& Stats = Tracker.GetStats();
+		TestEqual(TEXT("Received"), Stats.Received, (int64)99);
+		TestEqual(TEXT("Lost (reordered frames aren't lost)"), Stats.Lost, (int64)0);
+		TestEqual(TEXT("Late"), Stats.Late, (int64)1);
+		TestEqual(TEXT("Duplicates"), Stats.Duplicates, (int64)2);
+		TestEqual(TEXT("Resyncs"), Stats.Resyncs, (int64)0);
+	}
+
+	// Lost frames, and frames too old to be tracked after a large gap
+	{
+		FHoudiniLiveLinkSequenceTracker Tracker;
+		for (uint32 Sequence = 0; Sequence < 10; ++Sequence)
+		{
+			Tracker.Accept(StreamId, Sequence);
+		}
+
+		TestTrue(TEXT("Frame after a large gap"), Tracker.Accept(StreamId, 200));
+		TestFalse(TEXT("Reordered frame"), Tracker.Accept(StreamId, 150));
+		TestFalse(TEXT("Duplicate of the reordered frame"), Tracker.Accept(StreamId, 150));
+		TestFalse(TEXT("Out of window frame"), Tracker.Accept(StreamId, 100));
+		for (uint32 Sequence = 201; Sequence < 300; ++Sequence)
+		{
+			Tracker.Accept(StreamId, Sequence);
+		}
+
+		// 10 to 199 never arrived, except 150
+		const FHoudiniLiveLinkStreamStats& Stats = Tracker.GetStats();
+		TestEqual(TEXT("Lost after a gap"), Stats.Lost, (int64)189);
+		TestEqual(TEXT("Late after a gap"), Stats.Late, (int64)1);
+		TestEqual(TEXT("Duplicates after a gap"), Stats.Duplicates, (int64)1);
+		TestEqual(TEXT("Out of window after a gap"), Stats.OutOfWindow, (int64)1);
+	}
+
+	// Sequence wrapping around
+	{
+		FHoudiniLiveLinkSequenceTracker Tracker;
+		int32 NumAccepted = 0;
+		for (uint32 Sequence = 0xFFFFFFF0u; Sequence != 0x10u; ++Sequence)
+		{
+			NumAccepted += Tracker.Accept(StreamId, Sequence) ? 1 : 0;
+		}
+
+		TestEqual(TEXT("Frames accepted across the wrap"), NumAccepted, 32);
+		TestFalse(TEXT("Duplicate from before the wrap"), Tracker.Accept(StreamId, 0xFFFFFFFFu));
+		TestEqual(TEXT("Resyncs across the wrap"), Tracker.GetStats().Resyncs, (int64)0);
+	}
+
+	// Sender restarting
+	{
+		FHoudiniLiveLinkSequenceTracker Tracker;
+		for (uint32 Sequence = 0; Sequence < 500; ++Sequence)
+		{
+			Tracker.Accept(StreamId, Sequence);
+		}
+
+		TestTrue(TEXT("New stream id"), Tracker.Accept(StreamId + 1, 0));
+		TestEqual(TEXT("Resync on a new stream id"), Tracker.GetStats().Resyncs, (int64)1);
+	}
+
+	for (uint32 FramesBeforeRestart : { 30u, 500u })
+	{
+		// Restarting without changing the stream id: only the first frames are rejected
+		FHoudiniLiveLinkSequenceTracker Tracker;
+		for (uint32 Sequence = 0; Sequence < FramesBeforeRestart; ++Sequence)
+		{
+			Tracker.Accept(StreamId, Sequence);
+		}
+
+		int32 NumAccepted = 0;
+		for (uint32 Sequence = 0; Sequence < 600; ++Sequence)
+		{
+			NumAccepted += Tracker.Accept(StreamId, Sequence) ? 1 : 0;
+		}
+
+		TestEqual(FString::Printf(TEXT("Frames accepted after a restart at %u"), FramesBeforeRestart), NumAccepted, 593);
+		TestEqual(FString::Printf(TEXT("Resyncs after a restart at %u"), FramesBeforeRestart), Tracker.GetStats().Resyncs, (int64)1);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,116 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#include "../HoudiniLiveLinkSkeletonCache.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHoudiniLiveLinkSkeletonCacheTest, "Plugins.HoudiniLiveLink.SkeletonCache", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool
+FHoudiniLiveLinkSkeletonCacheTest::RunTest(const FString& Parameters)
+{
+	const FName SubjectName(TEXT("Subject"));
+
+	FHoudiniLiveLinkSkeleton Skeleton;
+	Skeleton.BoneNameStrings = { TEXT("Root"), TEXT("Arm") };
+	Skeleton.CurveNameStrings = { TEXT("Smile") };
+	Skeleton.StaticData.BoneNames = { FName(TEXT("Root")), FName(TEXT("Arm")) };
+	Skeleton.StaticData.BoneParents = { -1, 0 };
+	Skeleton.StaticData.PropertyNames = { FName(TEXT("Smile")) };
+	Skeleton.UpdateHash();
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	FHoudiniLiveLinkSkeletonCache::Save(Writer, SubjectName, Skeleton);
+
+	{
+		FName LoadedSubjectName;
+		FHoudiniLiveLinkSkeleton LoadedSkeleton;
+		FMemoryReader Reader(Data);
+		TestTrue(TEXT("Load a skeleton"), FHoudiniLiveLinkSkeletonCache::Load(Reader, LoadedSubjectName, LoadedSkeleton));
+		TestEqual(TEXT("Subject name"), LoadedSubjectName, SubjectName);
+		TestEqual(TEXT("Skeleton hash"), LoadedSkeleton.Hash, Skeleton.Hash);
+		TestEqual(TEXT("Bone names"), LoadedSkeleton.BoneNameStrings, Skeleton.BoneNameStrings);
+		TestEqual(TEXT("Bone parents"), LoadedSkeleton.StaticData.BoneParents, Skeleton.StaticData.BoneParents);
+	}
+
+	// Interrupted writes
+	for (int32 Size = 0; Size < Data.Num(); ++Size)
+	{
+		const TArray<uint8> Truncated(Data.GetData(), Size);
+		FName LoadedSubjectName;
+		FHoudiniLiveLinkSkeleton LoadedSkeleton;
+		FMemoryReader Reader(Truncated);
+		TestFalse(FString::Printf(TEXT("Load a skeleton truncated to %d bytes"), Size), FHoudiniLiveLinkSkeletonCache::Load(Reader, LoadedSubjectName, LoadedSkeleton));
+	}
+
+	// Corrupted counts must not be allocated: magic, version, hash, then the subject name (length and null terminator)
+	{
+		TArray<uint8> Corrupted = Data;
+		const int32 NumBonesOffset = 16 + sizeof(int32) + SubjectName.ToString().Len() + 1;
+		const int32 NumBones = MAX_int32;
+		FMemory::Memcpy(&Corrupted[NumBonesOffset], &NumBones, sizeof(NumBones));
+
+		FName LoadedSubjectName;
+		FHoudiniLiveLinkSkeleton LoadedSkeleton;
+		FMemoryReader Reader(Corrupted);
+		TestFalse(TEXT("Load a skeleton with a corrupted bone count"), FHoudiniLiveLinkSkeletonCache::Load(Reader, LoadedSubjectName, LoadedSkeleton));
+	}
+
+	// Preloading skips the truncated files
+	const FString Directory = FPaths::AutomationTransientDir() / TEXT("HoudiniLiveLinkSkeletonCache");
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	FFileHelper::SaveArrayToFile(Data, *(Directory / TEXT("00000001_0000000000000001.hlls")));
+	FFileHelper::SaveArrayToFile(TArray<uint8>(Data.GetData(), Data.Num() / 2), *(Directory / TEXT("00000001_0000000000000002.hlls")));
+	{
+		FHoudiniLiveLinkSkeletonCache Cache(Directory);
+		Cache.StartPreload();
+
+		const double Timeout = FPlatformTime::Seconds() + 10.0;
+		while (!Cache.IsLoaded() && FPlatformTime::Seconds() < Timeout)
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		TestTrue(TEXT("Preload the cache"), Cache.IsLoaded());
+		TestNotNull(TEXT("Find the preloaded skeleton"), Cache.Find(SubjectName, Skeleton.Hash));
+	}
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
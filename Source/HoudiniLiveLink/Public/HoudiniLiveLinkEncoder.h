@@ -0,0 +1,181 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+// Native encoder for the packets received by FHoudiniLiveLinkSource.
+// Like HoudiniLiveLinkProtocol.h, this only depends on the C++ standard library so it can be built
+// outside of Unreal, for example as a shared library loaded from Houdini's Python (see the C API below).
+
+#include "HoudiniLiveLinkProtocol.h"
+
+#include <string>
+#include <vector>
+
+// Largest UDP datagram we can send
+#define HOUDINI_LIVELINK_MAX_PACKET_SIZE	65507
+
+// Compresses Src into Dst with the given EHoudiniLiveLinkCompression codec.
+// Returns the compressed size, or 0 if the data couldn't be compressed.
+typedef int32_t (*FHoudiniLiveLinkCompressFunc)(uint8_t Compression, const void* Src, int32_t SrcSize, void* Dst, int32_t DstCapacity, void* UserData);
+
+// Writes a float as JSON, with '.' as the decimal separator whatever the locale, and enough digits to round-trip.
+// NaN/Inf are written as 0. Returns the length written (without the null terminator).
+int32_t HoudiniLiveLinkFormatFloat(float Value, char* Buffer, int32_t BufferSize);
+
+// Pose of a frame, as flat float buffers in Houdini space
+struct FHoudiniLiveLinkFrame
+{
+	int32_t NumBones = 0;
+
+	// NumBones * 3 floats each, except rotations (see RotationSize). Scales can be null.
+	const float* Positions = nullptr;
+	const float* Rotations = nullptr;
+	const float* Scales = nullptr;
+
+	// 3: euler angles in degrees, 4: quaternions (x, y, z, w)
+	int32_t RotationSize = 3;
+
+	// NumCurves floats, can be null
+	int32_t NumCurves = 0;
+	const float* Curves = nullptr;
+};
+
+class FHoudiniLiveLinkEncoder
+{
+	public:
+
+		// StreamId should be random and change every time the sender (re)starts streaming
+		explicit FHoudiniLiveLinkEncoder(uint32_t InStreamId);
+
+		// Sends the frames as a named subject (HoudiniLiveLinkSubjectId), instead of the subject set on the source.
+		// Each subject should be sent from its own socket so all its frames reach the same receive thread.
+		void SetSubject(const char* InSubjectName);
+
+		// Sets the skeleton sent along with the static data, parents are -1 for roots
+		void SetSkeleton(const char* const* InBoneNames, const int32_t* InBoneParents, int32_t InNumBones, const char* const* InCurveNames, int32_t InNumCurves);
+
+		// Sends the curves as deltas against a full curve frame sent every FullInterval frames.
+		// 0 (the default) always sends all the curves.
+		void SetSparseCurves(int32_t FullInterval);
+
+		// Compresses the payloads bigger than Threshold with the given codec
+		void SetCompression(uint8_t InCompression, FHoudiniLiveLinkCompressFunc InCompressFunc, void* InUserData, int32_t InThreshold = HOUDINI_LIVELINK_COMPRESSION_THRESHOLD);
+
+		// Encodes the packet for a frame, with the skeleton's static data if bIncludeSkeleton is set.
+		// SendTime is the sender's clock in microseconds, used by the receiver to measure latency.
+		// Returns false if the packet doesn't fit in a datagram.
+		bool EncodeFrame(const FHoudiniLiveLinkFrame& Frame, bool bIncludeSkeleton, uint64_t SendTime = 0);
+
+		// Last encoded packet
+		const uint8_t* GetPacketData() const { return Packet.data(); }
+		int32_t GetPacketSize() const { return (int32_t)Packet.size(); }
+
+		uint64_t GetSkeletonHash() const { return SkeletonHash; }
+
+		// Sends all the curves with the next frame
+		void ResetCurves() { CurveKey = -1; }
+
+	private:
+
+		void WriteFloat(float Value);
+		void WriteVectors(const char* Key, const float* Values, int32_t Count, int32_t Size);
+		void WriteFloats(const char* Key, const float* Values, int32_t Count);
+		void WriteString(const std::string& Value);
+		void WriteStrings(const char* Key, const std::vector<std::string>& Values);
+		void WriteKey(const char* Key);
+
+		// How a frame changes the sparse curve state, applied once its packet is known to fit
+		enum class ECurveUpdate
+		{
+			None,
+			Full,
+			Delta
+		};
+
+		ECurveUpdate WriteCurves(const float* Curves, int32_t NumCurves);
+		void WriteSkeleton();
+
+		uint32_t StreamId;
+		uint32_t Sequence;
+
+		// Named subject, sent with the static data
+		std::string SubjectName;
+		uint32_t SubjectId;
+
+		// Skeleton
+		std::vector<std::string> BoneNames;
+		std::vector<int32_t> BoneParents;
+		std::vector<std::string> CurveNames;
+		uint64_t SkeletonHash;
+
+		// Sparse curves
+		int32_t FullCurveInterval;
+		int32_t FramesSinceFullCurves;
+		int32_t CurveKey;
+		std::vector<float> BaseCurves;
+		std::vector<int32_t> DeltaIndices;
+		std::vector<float> DeltaValues;
+
+		// Compression
+		uint8_t Compression;
+		FHoudiniLiveLinkCompressFunc CompressFunc;
+		void* CompressUserData;
+		int32_t CompressionThreshold;
+
+		// JSON payload and final packet
+		std::string Json;
+		std::vector<uint8_t> Packet;
+};
+
+// C API, usable from Python with ctypes or from a Houdini C extension
+#if defined(_WIN32) && defined(HOUDINI_LIVELINK_ENCODER_DLL)
+	#define HOUDINI_LIVELINK_ENCODER_API __declspec(dllexport)
+#else
+	#define HOUDINI_LIVELINK_ENCODER_API
+#endif
+
+extern "C"
+{
+	HOUDINI_LIVELINK_ENCODER_API void* HoudiniLiveLinkEncoder_Create(uint32_t StreamId);
+	HOUDINI_LIVELINK_ENCODER_API void HoudiniLiveLinkEncoder_Destroy(void* Encoder);
+
+	HOUDINI_LIVELINK_ENCODER_API void HoudiniLiveLinkEncoder_SetSubject(void* Encoder, const char* SubjectName);
+	HOUDINI_LIVELINK_ENCODER_API void HoudiniLiveLinkEncoder_SetSkeleton(void* Encoder, const char* const* BoneNames, const int32_t* BoneParents, int32_t NumBones, const char* const* CurveNames, int32_t NumCurves);
+	HOUDINI_LIVELINK_ENCODER_API void HoudiniLiveLinkEncoder_SetSparseCurves(void* Encoder, int32_t FullInterval);
+	HOUDINI_LIVELINK_ENCODER_API void HoudiniLiveLinkEncoder_SetCompression(void* Encoder, uint8_t Compression, FHoudiniLiveLinkCompressFunc CompressFunc, void* UserData, int32_t Threshold);
+	HOUDINI_LIVELINK_ENCODER_API void HoudiniLiveLinkEncoder_ResetCurves(void* Encoder);
+
+	// Returns the size of the packet (0 on failure) and sets OutData to its data, valid until the next call.
+	// Rotations are euler angles (3 floats per bone), or quaternions (4 floats per bone) with EncodeFrameQuat.
+	HOUDINI_LIVELINK_ENCODER_API int32_t HoudiniLiveLinkEncoder_EncodeFrame(void* Encoder, int32_t NumBones, const float* Positions, const float* Rotations, const float* Scales,
+		int32_t NumCurves, const float* Curves, int32_t bIncludeSkeleton, uint64_t SendTime, const uint8_t** OutData);
+	HOUDINI_LIVELINK_ENCODER_API int32_t HoudiniLiveLinkEncoder_EncodeFrameQuat(void* Encoder, int32_t NumBones, const float* Positions, const float* Rotations, const float* Scales,
+		int32_t NumCurves, const float* Curves, int32_t bIncludeSkeleton, uint64_t SendTime, const uint8_t** OutData);
+
+	// Writes the pong answering a ping received from the plugin, returns its size (0 if the packet isn't a ping)
+	HOUDINI_LIVELINK_ENCODER_API int32_t HoudiniLiveLinkEncoder_MakePong(const uint8_t* Ping, int32_t PingSize, uint8_t* Pong, int32_t PongSize, uint64_t ReceiveTime, uint64_t SendTime);
+}
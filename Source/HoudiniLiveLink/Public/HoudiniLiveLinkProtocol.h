@@ -0,0 +1,256 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+// Packet definitions shared between the Houdini senders and FHoudiniLiveLinkSource.
+// This file only depends on the C standard library so it can be used outside of Unreal.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Every packet can be prefixed by a small binary header.
+// Packets that don't start with the header magic are plain JSON (legacy senders).
+// All values are little-endian.
+//
+// Python equivalent: struct.pack("<IBBHIIB3xIQIQ", MAGIC, VERSION, TYPE, HEADER_SIZE, stream_id, sequence, compression, uncompressed_size, send_time, subject_id, skeleton_hash)
+
+#define HOUDINI_LIVELINK_MAGIC		0x4B4C4C48	// "HLLK"
+#define HOUDINI_LIVELINK_VERSION	1
+
+// Payloads smaller than this are better sent uncompressed
+#define HOUDINI_LIVELINK_COMPRESSION_THRESHOLD	1024
+
+// Largest payload size accepted once decompressed
+#define HOUDINI_LIVELINK_MAX_UNCOMPRESSED_SIZE	(1024 * 1024)
+
+enum EHoudiniLiveLinkPacketType : uint8_t
+{
+	HLL_PACKET_FRAME = 0,		// JSON payload (static and/or frame data)
+	HLL_PACKET_PING = 1,		// Sent by the receiver to the sender, FHoudiniLiveLinkPingPayload
+	HLL_PACKET_PONG = 2,		// Sender's answer to a ping, FHoudiniLiveLinkPingPayload
+};
+
+enum EHoudiniLiveLinkCompression : uint8_t
+{
+	HLL_COMPRESSION_NONE = 0,
+	HLL_COMPRESSION_ZLIB = 1,	// zlib stream (Python's zlib.compress)
+	HLL_COMPRESSION_LZ4 = 2,	// LZ4 block
+};
+
+#pragma pack(push, 1)
+struct FHoudiniLiveLinkPacketHeader
+{
+	// Must be HOUDINI_LIVELINK_MAGIC
+	uint32_t Magic;
+
+	// Protocol version, only bumped for incompatible changes
+	uint8_t Version;
+
+	// EHoudiniLiveLinkPacketType
+	uint8_t Type;
+
+	// Size of the header in bytes, the payload starts right after it.
+	// New fields are appended at the end of the header, readers ignore the ones they don't know.
+	uint16_t HeaderSize;
+
+	// Random identifier the sender must choose anew every time it (re)starts streaming.
+	// The receiver resets its sequence tracking when it changes.
+	uint32_t StreamId;
+
+	// Incremented by one by the sender for every frame packet of a stream
+	uint32_t Sequence;
+
+	// EHoudiniLiveLinkCompression used for the payload
+	uint8_t Compression;
+	uint8_t Padding[3];
+
+	// Size of the payload once decompressed, only used if it is compressed
+	uint32_t UncompressedSize;
+
+	// Sender's clock (in microseconds) when the frame was evaluated, 0 if unknown.
+	// Used with the clock offset estimated by ping/pong to measure the latency.
+	uint64_t SendTime;
+
+	// HoudiniLiveLinkSubjectId() of the subject the packet belongs to, 0 for the source's own subject.
+	// Lets several subjects share a port, each with its own stream.
+	uint32_t SubjectId;
+
+	// Hash (see below) of the skeleton the frame data belongs to, 0 if unknown.
+	// Lets the receiver use a skeleton it already knows without waiting for the static data.
+	uint64_t SkeletonHash;
+};
+
+// Payload of the ping/pong packets, used to estimate the offset between the sender and receiver clocks.
+// The receiver sends a ping with ReceiverTime set, the sender answers right away with a pong
+// containing the same ReceiverTime, and the times (on its clock, in microseconds) it received the ping and sent the pong.
+struct FHoudiniLiveLinkPingPayload
+{
+	uint64_t ReceiverTime;
+	uint64_t SenderReceiveTime;
+	uint64_t SenderSendTime;
+};
+#pragma pack(pop)
+
+// Reads the header at the start of a packet.
+// Returns false if the packet doesn't start with a valid header.
+// Fields missing from an older/shorter header are zeroed.
+inline bool
+HoudiniLiveLinkReadHeader(const void* Data, int32_t Size, FHoudiniLiveLinkPacketHeader& OutHeader)
+{
+	memset(&OutHeader, 0, sizeof(OutHeader));
+
+	const int32_t MinSize = (int32_t)offsetof(FHoudiniLiveLinkPacketHeader, StreamId);
+	if (!Data || Size < MinSize)
+		return false;
+
+	memcpy(&OutHeader, Data, MinSize);
+	if (OutHeader.Magic != HOUDINI_LIVELINK_MAGIC || OutHeader.Version != HOUDINI_LIVELINK_VERSION)
+		return false;
+
+	if (OutHeader.HeaderSize < MinSize || OutHeader.HeaderSize > Size)
+		return false;
+
+	const int32_t CopySize = OutHeader.HeaderSize < sizeof(OutHeader) ? OutHeader.HeaderSize : (int32_t)sizeof(OutHeader);
+	memcpy(&OutHeader, Data, CopySize);
+
+	return true;
+}
+
+// Writes a header for a packet of the given type, returns the number of bytes written
+inline int32_t
+HoudiniLiveLinkWriteHeader(void* Data, int32_t Size, uint8_t Type, uint32_t StreamId, uint32_t Sequence, uint32_t SubjectId = 0)
+{
+	if (!Data || Size < (int32_t)sizeof(FHoudiniLiveLinkPacketHeader))
+		return 0;
+
+	FHoudiniLiveLinkPacketHeader Header;
+	memset(&Header, 0, sizeof(Header));
+	Header.Magic = HOUDINI_LIVELINK_MAGIC;
+	Header.Version = HOUDINI_LIVELINK_VERSION;
+	Header.Type = Type;
+	Header.HeaderSize = (uint16_t)sizeof(Header);
+	Header.StreamId = StreamId;
+	Header.Sequence = Sequence;
+	Header.SubjectId = SubjectId;
+
+	memcpy(Data, &Header, sizeof(Header));
+	return (int32_t)sizeof(Header);
+}
+
+// Turns a ping packet into the pong packet to send back, returns the size of the pong (0 if Ping isn't a ping)
+inline int32_t
+HoudiniLiveLinkMakePong(const void* Ping, int32_t PingSize, void* Pong, int32_t PongSize, uint64_t ReceiveTime, uint64_t SendTime)
+{
+	FHoudiniLiveLinkPacketHeader Header;
+	if (!HoudiniLiveLinkReadHeader(Ping, PingSize, Header) || Header.Type != HLL_PACKET_PING)
+		return 0;
+
+	if (PingSize - Header.HeaderSize < (int32_t)sizeof(uint64_t))
+		return 0;
+
+	FHoudiniLiveLinkPingPayload Payload;
+	memcpy(&Payload.ReceiverTime, (const uint8_t*)Ping + Header.HeaderSize, sizeof(uint64_t));
+	Payload.SenderReceiveTime = ReceiveTime;
+	Payload.SenderSendTime = SendTime;
+
+	if (PongSize < (int32_t)(sizeof(FHoudiniLiveLinkPacketHeader) + sizeof(Payload)))
+		return 0;
+
+	const int32_t HeaderSize = HoudiniLiveLinkWriteHeader(Pong, PongSize, HLL_PACKET_PONG, Header.StreamId, Header.Sequence, Header.SubjectId);
+	memcpy((uint8_t*)Pong + HeaderSize, &Payload, sizeof(Payload));
+	return HeaderSize + (int32_t)sizeof(Payload);
+}
+
+// Skeleton hash (64bit FNV-1a) over the bone names, the bone parents (-1 for roots)
+// and the curve names, in that order. Names are hashed as UTF-8 followed by a null byte.
+#define HOUDINI_LIVELINK_HASH_SEED	0xcbf29ce484222325ULL
+
+inline uint64_t
+HoudiniLiveLinkHashBytes(uint64_t Hash, const void* Data, int32_t Size)
+{
+	const uint8_t* Bytes = (const uint8_t*)Data;
+	for (int32_t i = 0; i < Size; ++i)
+	{
+		Hash ^= Bytes[i];
+		Hash *= 0x100000001b3ULL;
+	}
+	return Hash;
+}
+
+inline uint64_t
+HoudiniLiveLinkHashString(uint64_t Hash, const char* Str, int32_t Length)
+{
+	const uint8_t Terminator = 0;
+	Hash = HoudiniLiveLinkHashBytes(Hash, Str, Length);
+	return HoudiniLiveLinkHashBytes(Hash, &Terminator, 1);
+}
+
+inline uint64_t
+HoudiniLiveLinkHashInt(uint64_t Hash, int32_t Value)
+{
+	// Little-endian
+	const uint32_t Bits = (uint32_t)Value;
+	uint8_t Bytes[4] = { (uint8_t)(Bits & 0xFF), (uint8_t)((Bits >> 8) & 0xFF), (uint8_t)((Bits >> 16) & 0xFF), (uint8_t)((Bits >> 24) & 0xFF) };
+	return HoudiniLiveLinkHashBytes(Hash, Bytes, 4);
+}
+
+// Hash of a skeleton, shared by the senders and the receiver so they always agree on it.
+// GetBoneName(Index, OutLength) and GetCurveName(Index, OutLength) return the UTF-8 names, which don't need to be null terminated.
+template <typename FGetBoneName, typename FGetCurveName>
+inline uint64_t
+HoudiniLiveLinkHashSkeleton(int32_t NumBones, FGetBoneName GetBoneName, const int32_t* BoneParents, int32_t NumCurves, FGetCurveName GetCurveName)
+{
+	uint64_t Hash = HOUDINI_LIVELINK_HASH_SEED;
+	int32_t Length = 0;
+	for (int32_t BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+	{
+		const char* Name = GetBoneName(BoneIdx, Length);
+		Hash = HoudiniLiveLinkHashString(Hash, Name, Length);
+	}
+
+	// Every root is sent (and decoded) as -1
+	for (int32_t BoneIdx = 0; BoneIdx < NumBones; ++BoneIdx)
+		Hash = HoudiniLiveLinkHashInt(Hash, BoneParents[BoneIdx] < 0 ? -1 : BoneParents[BoneIdx]);
+
+	for (int32_t CurveIdx = 0; CurveIdx < NumCurves; ++CurveIdx)
+	{
+		const char* Name = GetCurveName(CurveIdx, Length);
+		Hash = HoudiniLiveLinkHashString(Hash, Name, Length);
+	}
+
+	return Hash;
+}
+
+// Identifier of a named subject in the packet headers (32bit fold of the FNV-1a hash of its UTF-8 name), never 0
+inline uint32_t
+HoudiniLiveLinkSubjectId(const char* Name, int32_t Length)
+{
+	const uint64_t Hash = HoudiniLiveLinkHashBytes(HOUDINI_LIVELINK_HASH_SEED, Name, Length);
+	const uint32_t SubjectId = (uint32_t)(Hash ^ (Hash >> 32));
+	return SubjectId != 0 ? SubjectId : 1;
+}
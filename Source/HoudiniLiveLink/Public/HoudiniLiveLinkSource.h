@@ -1,112 +1,306 @@
-/*
-* Copyright (c) <2020> Side Effects Software Inc.
-* All rights reserved.
-*
-* Redistribution and use in source and binary forms, with or without
-* modification, are permitted provided that the following conditions are met:
-*
-* 1. Redistributions of source code must retain the above copyright notice,
-*    this list of conditions and the following disclaimer.
-*
-* 2. The name of Side Effects Software may not be used to endorse or
-*    promote products derived from this software without specific prior
-*    written permission.
-*
-* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
-* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
-* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
-* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
-* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
-* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
-* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
-* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
-* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-*/
-
-#pragma once
-
-#include "ILiveLinkSource.h"
-#include "HAL/Runnable.h"
-#include "HAL/ThreadSafeBool.h"
-#include "IMessageContext.h"
-#include "Interfaces/IPv4/IPv4Endpoint.h"
-#include "Containers/Set.h"
-
-class FRunnableThread;
-class ILiveLinkClient;
-
-class HOUDINILIVELINK_API FHoudiniLiveLinkSource : public ILiveLinkSource, public FRunnable
-{
-	public:
-
-		FHoudiniLiveLinkSource(FIPv4Endpoint Endpoint, const float& InRefreshRate, const FString& InSubjectName);
-
-		virtual ~FHoudiniLiveLinkSource();
-
-		// Begin ILiveLinkSource Interface
-	
-		virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
-
-		virtual bool IsSourceStillValid() const override;
-
-		virtual bool RequestSourceShutdown() override;
-
-		virtual FText GetSourceType() const override { return SourceType; };
-		virtual FText GetSourceMachineName() const override { return SourceMachineName; }
-		virtual FText GetSourceStatus() const override { return SourceStatus; }
-
-		// End ILiveLinkSource Interface
-
-		// Begin FRunnable Interface
-
-		virtual bool Init() override { return true; }
-		virtual uint32 Run() override;
-		void Start();
-		virtual void Stop() override;
-		virtual void Exit() override { }
-
-		// End FRunnable Interface
-
-		bool ProcessResponseData(const FString& ReceivedData);
-
-	private:
-
-		ILiveLinkClient* Client;
-
-		// Our identifier in LiveLink
-		FGuid SourceGuid;
-
-		// Source Infos
-		FText SourceType;
-		FText SourceMachineName;
-		FText SourceStatus;
-
-		FName SubjectName;
-		
-		int NumBones;
-		int NumCurves;
-		TSet<int> Roots;
-
-		// Machine/Port we're connected to
-		FIPv4Endpoint DeviceEndpoint;
-
-		// Threadsafe Bool for terminating the main thread loop
-		FThreadSafeBool Stopping;
-
-		// Thread to run socket operations on
-		FRunnableThread* Thread;
-
-		// Name of the sockets thread
-		FString ThreadName;
-
-		// Indicates that the skeleton needs to be setup from houdini first
-		bool SkeletonSetupNeeded;
-
-		// Frequency update (sleep time between each update)
-		float UpdateFrequency;
-
-		// Transform scale
-		// currently unused
-		static const double TransformScale;
-};
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "ILiveLinkSource.h"
+#include "Roles/LiveLinkAnimationTypes.h"
+#include "HAL/ThreadSafeBool.h"
+#include "IMessageContext.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Containers/Set.h"
+#include "Misc/ScopeLock.h"
+#include "Containers/CircularQueue.h"
+#include "Async/Future.h"
+
+class FHoudiniLiveLinkReceiver;
+class FHoudiniLiveLinkSkeletonCache;
+struct FHoudiniLiveLinkSkeleton;
+class ILiveLinkClient;
+
+// Optional settings of a Houdini LiveLink source
+struct HOUDINILIVELINK_API FHoudiniLiveLinkSourceOptions
+{
+	// Multicast group to join, only unicast packets are received if this isn't a multicast address
+	FIPv4Address MulticastGroup = FIPv4Address::Any;
+
+	// Local interface used to join the group, Any lets the system choose
+	FIPv4Address MulticastInterface = FIPv4Address::Any;
+
+	// Time to live of the multicast packets sent by the source
+	uint8 MulticastTtl = 1;
+
+	// Number of frames buffered between the receive threads and the capture file, 0 disables capture
+	int32 CaptureBufferSize = 0;
+
+	// Object path of a skeleton asset: frames are pushed in its bone layout instead of Houdini's
+	FString TargetSkeleton;
+
+	// Houdini bone name -> target bone name. Without a target skeleton, only the bones in the map are pushed.
+	// In the connection string: BoneMap="HoudiniName:TargetName,HoudiniName:TargetName"
+	TMap<FName, FName> BoneNameMap;
+
+	// Number of sockets/threads receiving on the port, the system spreads the senders between them.
+	// Only used for unicast, on platforms that balance reusable sockets (SO_REUSEPORT).
+	int32 NumReceiveThreads = 1;
+
+	// Also computes the component space transforms of every frame, see GetComponentSpacePose()
+	bool bComputeComponentSpace = false;
+
+	// Directory of the skeleton cache, Saved/HoudiniLiveLink/Skeletons if empty. Not part of the connection string.
+	FString SkeletonCacheDirectory;
+
+	bool UsesMulticast() const { return MulticastGroup.IsMulticastAddress(); }
+
+	// Converts the options to/from the text appended to the LiveLink connection string
+	FString ToString() const;
+	static void Parse(const FString& InString, FHoudiniLiveLinkSourceOptions& OutOptions);
+
+	// Converts the bone name map to/from "HoudiniName:TargetName,HoudiniName:TargetName"
+	static FString BoneNameMapToString(const TMap<FName, FName>& InMap);
+	static void ParseBoneNameMap(const FString& InString, TMap<FName, FName>& OutMap);
+};
+
+// Bone layout frames are remapped to (from the target skeleton asset)
+struct FHoudiniLiveLinkTargetLayout
+{
+	TArray<FName> BoneNames;
+	TArray<int32> BoneParents;
+
+	// Used for the target bones that don't exist in Houdini
+	TArray<FTransform> RefPose;
+};
+
+// Precomputed mapping from a Houdini skeleton to the layout pushed to LiveLink
+struct FHoudiniLiveLinkBoneMap
+{
+	// Bones pushed to LiveLink
+	TArray<FName> BoneNames;
+	TArray<int32> BoneParents;
+
+	// For each output bone, the Houdini bones (from ChainStart[i] to ChainStart[i + 1]) whose local transforms
+	// are composed, top-down, into its local transform. Bones removed in between are folded into their children.
+	// An empty chain uses the RefPose.
+	TArray<int32> ChainStart;
+	TArray<int32> ChainIndices;
+	TArray<FTransform> RefPose;
+
+	// Inverse of the RefPoses of the unmapped target bones between an output bone and its closest mapped
+	// ancestor, applied after the chain since those bones keep their RefPose. Empty if no bone needs one.
+	TArray<FTransform> ParentOffsets;
+
+	// Maps a Houdini skeleton to the target layout if there is one, otherwise to the bones of BoneNameMap
+	void Build(const FLiveLinkSkeletonStaticData& Source, const FHoudiniLiveLinkTargetLayout* TargetLayout, const TMap<FName, FName>& BoneNameMap);
+
+	// Converts a frame from the Houdini layout to the output layout
+	void Apply(const TArray<FTransform>& InTransforms, TArray<FTransform>& OutTransforms) const;
+};
+
+// Component space pose of a subject's last frame
+struct FHoudiniLiveLinkComponentSpacePose
+{
+	// Receive time (FPlatformTime::Seconds)
+	double Time = 0.0;
+
+	// Static data pushed for the subject, the transforms follow its bone order
+	TSharedPtr<const FLiveLinkSkeletonStaticData, ESPMode::ThreadSafe> Skeleton;
+
+	TArray<FTransform> Transforms;
+};
+
+// Frame stored by the capture buffer, at the rate it was received
+struct FHoudiniLiveLinkCapturedFrame
+{
+	// Receive time (FPlatformTime::Seconds)
+	double Time = 0.0;
+
+	// Time the sender sent the frame (sender clock, in microseconds), 0 if it doesn't timestamp its frames
+	uint64 SendTime = 0;
+
+	FName SubjectName;
+
+	// Skeleton the frame belongs to, shared by all the frames using it
+	TSharedPtr<const FLiveLinkSkeletonStaticData, ESPMode::ThreadSafe> Skeleton;
+
+	TArray<FTransform> Transforms;
+	TArray<float> PropertyValues;
+};
+
+// Counters describing the quality of a sequenced stream
+struct FHoudiniLiveLinkStreamStats
+{
+	// Frames accepted and applied
+	int64 Received = 0;
+
+	// Frames that never arrived (gaps in the sequence), counted once 64 newer frames were received
+	int64 Lost = 0;
+
+	// Frames rejected because a newer frame was already applied (reordered)
+	int64 Late = 0;
+
+	// Frames received more than once
+	int64 Duplicates = 0;
+
+	// Frames too old to tell if they are late or duplicates (more than 64 frames behind), rejected.
+	// If they were never received before, they are also counted as lost.
+	int64 OutOfWindow = 0;
+
+	// Number of times the sender (re)started its stream
+	int64 Resyncs = 0;
+};
+
+// Latency between Houdini evaluating a frame and the source receiving it
+struct FHoudiniLiveLinkLatencyStats
+{
+	// Percentiles over the last measurement window, in milliseconds
+	double P50 = 0.0;
+	double P95 = 0.0;
+	double P99 = 0.0;
+
+	// Number of frames in the last window, 0 if the latency couldn't be measured
+	int64 NumSamples = 0;
+
+	// Estimated sender clock minus receiver clock, and round trip time, in milliseconds
+	double ClockOffset = 0.0;
+	double RoundTripTime = 0.0;
+};
+
+class HOUDINILIVELINK_API FHoudiniLiveLinkSource : public ILiveLinkSource
+{
+	public:
+
+		FHoudiniLiveLinkSource(FIPv4Endpoint Endpoint, const float& InRefreshRate, const FString& InSubjectName, const FHoudiniLiveLinkSourceOptions& InOptions = FHoudiniLiveLinkSourceOptions());
+
+		virtual ~FHoudiniLiveLinkSource();
+
+		// Begin ILiveLinkSource Interface
+	
+		virtual void ReceiveClient(ILiveLinkClient* InClient, FGuid InSourceGuid) override;
+
+		virtual bool IsSourceStillValid() const override;
+
+		virtual bool RequestSourceShutdown() override;
+
+		virtual FText GetSourceType() const override { return SourceType; };
+		virtual FText GetSourceMachineName() const override { return SourceMachineName; }
+		virtual FText GetSourceStatus() const override;
+
+		// End ILiveLinkSource Interface
+
+		// Starts/stops the receive threads. The source starts when LiveLink gives it its client.
+		void Start();
+		void Stop();
+
+		// Returns the loss/reorder/duplicate counters of the subjects' streams
+		FHoudiniLiveLinkStreamStats GetStreamStats() const;
+
+		// Returns the latency percentiles of the last measurement window
+		FHoudiniLiveLinkLatencyStats GetLatencyStats() const;
+
+		// Starts recording a take: every frame received from now on is written to Filename, in the background,
+		// until StopCapture(). Returns false if capture is disabled or the previous take is still being written.
+		bool StartCapture(const FString& Filename);
+
+		// Stops the take, the frames already received are written before the file is closed
+		void StopCapture();
+		bool IsCapturing() const { return bCapturing; }
+
+		// Number of frames of the current/last take that didn't fit in the capture buffer
+		int32 GetCaptureDroppedFrames() const { return CaptureDroppedFrames.GetValue(); }
+
+		// Subject of the packets that don't name one
+		FName GetSubjectName() const { return SubjectName; }
+
+		// Calls Function for every Houdini source, the sources can't be destroyed until it returns
+		static void ForEachSource(TFunctionRef<void(FHoudiniLiveLinkSource&)> Function);
+
+		// Copies the component space transforms of the subject's last frame.
+		// Returns false if the option is disabled or no frame was received for the subject.
+		bool GetComponentSpacePose(FName InSubjectName, FHoudiniLiveLinkComponentSpacePose& OutPose) const;
+
+		// Same as GetComponentSpacePose(), for sources added from the LiveLink panel: finds the subject among
+		// every Houdini source (the most recent pose if several sources receive it)
+		static bool FindComponentSpacePose(FName InSubjectName, FHoudiniLiveLinkComponentSpacePose& OutPose);
+
+	private:
+
+		friend class FHoudiniLiveLinkReceiver;
+
+		// Returns the (cached) bone map of a skeleton, null if no remapping is needed
+		TSharedPtr<const FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe> GetBoneMap(const FHoudiniLiveLinkSkeleton& Skeleton);
+
+		ILiveLinkClient* Client;
+
+		// Our identifier in LiveLink
+		FGuid SourceGuid;
+
+		// Source Infos
+		FText SourceType;
+		FText SourceMachineName;
+		FText SourceStatus;
+
+		// Subject of the packets that don't name one
+		FName SubjectName;
+
+		// Machine/Port we're connected to
+		FIPv4Endpoint DeviceEndpoint;
+
+		// Multicast settings
+		FHoudiniLiveLinkSourceOptions Options;
+
+		// Threadsafe Bool for terminating the receive loops
+		FThreadSafeBool Stopping;
+
+		// Receive threads, each with its own socket bound to the port
+		TArray<TUniquePtr<FHoudiniLiveLinkReceiver>> Receivers;
+
+		// Frequency update (sleep time between each update)
+		float UpdateFrequency;
+
+		// Layout of the target skeleton, resolved on creation
+		FHoudiniLiveLinkTargetLayout TargetLayout;
+		bool bHasTargetLayout;
+
+		// Skeletons received by previous sessions, loaded when starting
+		TUniquePtr<FHoudiniLiveLinkSkeletonCache> SkeletonCache;
+
+		// Bone maps, by skeleton hash, shared by the receive threads
+		TMap<uint64, TSharedPtr<const FHoudiniLiveLinkBoneMap, ESPMode::ThreadSafe>> BoneMapCache;
+		FCriticalSection BoneMapCacheLock;
+
+		// Writes the frames of the capture buffers to the file until the take stops
+		bool WriteCapture(const FString& Filename);
+
+		// Capture state, each receive thread has its own lock-free capture buffer
+		FThreadSafeBool bCapturing;
+		FThreadSafeBool bExportingCapture;
+		FThreadSafeCounter CaptureDroppedFrames;
+		TFuture<bool> CaptureExportResult;
+
+		// Last component space pose of each subject, written by the receive threads
+		TMap<FName, FHoudiniLiveLinkComponentSpacePose> ComponentSpacePoses;
+		mutable FCriticalSection ComponentSpacePosesLock;
+};
@@ -0,0 +1,209 @@
+/*
+* Copyright (c) <2020> Side Effects Software Inc.
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are met:
+*
+* 1. Redistributions of source code must retain the above copyright notice,
+*    this list of conditions and the following disclaimer.
+*
+* 2. The name of Side Effects Software may not be used to endorse or
+*    promote products derived from this software without specific prior
+*    written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY SIDE EFFECTS SOFTWARE "AS IS" AND ANY EXPRESS
+* OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+* OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN
+* NO EVENT SHALL SIDE EFFECTS SOFTWARE BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+* OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+* EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+// Load generator for the Houdini LiveLink source: several senders, each on its own socket and
+// streaming its own named subject, so the frames get spread between the source's receive threads.
+// Built with the native encoder, on Linux/macOS:
+//
+// g++ -O2 -std=c++14 -pthread -I Source/HoudiniLiveLink/Public Tools/HoudiniLiveLinkLoadTest.cpp Source/HoudiniLiveLink/Private/HoudiniLiveLinkEncoder.cpp -o houdinilivelinkloadtest
+//
+// Usage: houdinilivelinkloadtest [host] [port] [senders] [frames per second] [bones] [curves] [seconds]
+
+#include "HoudiniLiveLinkEncoder.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The static data is resent periodically, like the HDA does
+#define SKELETON_INTERVAL 60
+
+static uint64_t
+NowMicroseconds()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct FSenderSettings
+{
+	sockaddr_in Address;
+	int32_t FramesPerSecond;
+	int32_t NumBones;
+	int32_t NumCurves;
+	int32_t Seconds;
+};
+
+static std::atomic<int64_t> TotalFrames(0);
+static std::atomic<int64_t> TotalBytes(0);
+static std::atomic<int64_t> TotalPongs(0);
+
+static void
+RunSender(int32_t SenderIdx, const FSenderSettings& Settings)
+{
+	// One socket per sender: the source's receive threads are chosen by source address/port
+	int Socket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (Socket < 0)
+		return;
+
+	std::random_device Random;
+	FHoudiniLiveLinkEncoder Encoder((uint32_t)Random());
+
+	const std::string SubjectName = "LoadTest " + std::to_string(SenderIdx);
+	Encoder.SetSubject(SubjectName.c_str());
+
+	// A chain of bones, with a few curves
+	std::vector<std::string> BoneNames;
+	std::vector<int32_t> BoneParents;
+	for (int32_t BoneIdx = 0; BoneIdx < Settings.NumBones; ++BoneIdx)
+	{
+		BoneNames.push_back("bone" + std::to_string(BoneIdx));
+		BoneParents.push_back(BoneIdx - 1);
+	}
+
+	std::vector<std::string> CurveNames;
+	for (int32_t CurveIdx = 0; CurveIdx < Settings.NumCurves; ++CurveIdx)
+	{
+		CurveNames.push_back("curve" + std::to_string(CurveIdx));
+	}
+
+	std::vector<const char*> BoneNamePtrs;
+	for (const std::string& Name : BoneNames)
+		BoneNamePtrs.push_back(Name.c_str());
+
+	std::vector<const char*> CurveNamePtrs;
+	for (const std::string& Name : CurveNames)
+		CurveNamePtrs.push_back(Name.c_str());
+
+	Encoder.SetSkeleton(BoneNamePtrs.data(), BoneParents.data(), Settings.NumBones, CurveNamePtrs.data(), Settings.NumCurves);
+
+	std::vector<float> Positions(Settings.NumBones * 3, 0.0f);
+	std::vector<float> Rotations(Settings.NumBones * 3, 0.0f);
+	std::vector<float> Curves(Settings.NumCurves, 0.0f);
+
+	const auto FrameDuration = std::chrono::microseconds(1000000 / (Settings.FramesPerSecond > 0 ? Settings.FramesPerSecond : 1));
+	const int64_t NumFrames = (int64_t)Settings.FramesPerSecond * Settings.Seconds;
+	auto NextFrame = std::chrono::steady_clock::now();
+
+	for (int64_t Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		// Animate every bone so no frame is skipped as idle
+		const float Angle = (float)fmod(Frame * 3.0, 360.0);
+		for (int32_t BoneIdx = 0; BoneIdx < Settings.NumBones; ++BoneIdx)
+		{
+			Positions[BoneIdx * 3 + 1] = (float)BoneIdx;
+			Rotations[BoneIdx * 3 + 2] = Angle;
+		}
+
+		for (int32_t CurveIdx = 0; CurveIdx < Settings.NumCurves; ++CurveIdx)
+			Curves[CurveIdx] = (float)((Frame + CurveIdx) % 100) / 100.0f;
+
+		FHoudiniLiveLinkFrame FrameData;
+		FrameData.NumBones = Settings.NumBones;
+		FrameData.Positions = Positions.data();
+		FrameData.Rotations = Rotations.data();
+		FrameData.NumCurves = Settings.NumCurves;
+		FrameData.Curves = Curves.data();
+
+		if (Encoder.EncodeFrame(FrameData, (Frame % SKELETON_INTERVAL) == 0, NowMicroseconds()))
+		{
+			sendto(Socket, Encoder.GetPacketData(), Encoder.GetPacketSize(), 0, (const sockaddr*)&Settings.Address, sizeof(Settings.Address));
+			TotalFrames++;
+			TotalBytes += Encoder.GetPacketSize();
+		}
+
+		// Answer the pings, so the source measures the latency
+		uint8_t Ping[256];
+		uint8_t Pong[256];
+		sockaddr_in From;
+		socklen_t FromSize = sizeof(From);
+		ssize_t PingSize;
+		while ((PingSize = recvfrom(Socket, Ping, sizeof(Ping), MSG_DONTWAIT, (sockaddr*)&From, &FromSize)) > 0)
+		{
+			const uint64_t ReceiveTime = NowMicroseconds();
+			const int32_t PongSize = HoudiniLiveLinkMakePong(Ping, (int32_t)PingSize, Pong, sizeof(Pong), ReceiveTime, NowMicroseconds());
+			if (PongSize > 0)
+			{
+				sendto(Socket, Pong, PongSize, 0, (const sockaddr*)&From, FromSize);
+				TotalPongs++;
+			}
+			FromSize = sizeof(From);
+		}
+
+		NextFrame += FrameDuration;
+		std::this_thread::sleep_until(NextFrame);
+	}
+
+	close(Socket);
+}
+
+int
+main(int argc, char** argv)
+{
+	const char* Host = argc > 1 ? argv[1] : "127.0.0.1";
+	const int32_t Port = argc > 2 ? atoi(argv[2]) : 6000;
+	const int32_t NumSenders = argc > 3 ? atoi(argv[3]) : 8;
+
+	FSenderSettings Settings;
+	Settings.FramesPerSecond = argc > 4 ? atoi(argv[4]) : 240;
+	Settings.NumBones = argc > 5 ? atoi(argv[5]) : 60;
+	Settings.NumCurves = argc > 6 ? atoi(argv[6]) : 50;
+	Settings.Seconds = argc > 7 ? atoi(argv[7]) : 10;
+
+	memset(&Settings.Address, 0, sizeof(Settings.Address));
+	Settings.Address.sin_family = AF_INET;
+	Settings.Address.sin_port = htons((uint16_t)Port);
+	if (inet_pton(AF_INET, Host, &Settings.Address.sin_addr) != 1)
+	{
+		fprintf(stderr, "Invalid address: %s\n", Host);
+		return 1;
+	}
+
+	printf("%d senders -> %s:%d, %d fps, %d bones, %d curves, %ds\n",
+		NumSenders, Host, Port, Settings.FramesPerSecond, Settings.NumBones, Settings.NumCurves, Settings.Seconds);
+
+	std::vector<std::thread> Senders;
+	for (int32_t SenderIdx = 0; SenderIdx < NumSenders; ++SenderIdx)
+		Senders.emplace_back(RunSender, SenderIdx, std::cref(Settings));
+
+	for (std::thread& Sender : Senders)
+		Sender.join();
+
+	printf("%lld frames, %lld bytes, %lld pongs\n", (long long)TotalFrames.load(), (long long)TotalBytes.load(), (long long)TotalPongs.load());
+	return 0;
+}